@@ -191,6 +191,256 @@ typedef struct _HEAPDESC {
     void* CrumbleRear;
 }HEAPDESC, * PHEAPDESC;
 
+//
+// HEAPCTRL heap control, common to all memory suballocator instances
+//
+// NOTE:    FREEMEM blocks are kept in size class lists, linked through CrumbleFront (next)
+//          and CrumbleRear (previous) of the HEAPDESC.
+//          Size classes are split in two levels: power of two of the block size and
+//          four sub classes below each power of two. A bitmap marks non-empty classes.
+//
+//          Small blocks up to CDE_SLAB_CLASSES * CDE_HEAP_ALIGN bytes are taken from slab pages.
+//          A slab page is a single page, that starts with SLABDESC and is carved into
+//          fixed size slots. qwMagic and fInalterable are at the same offset as in HEAPDESC.
+//          A pointer is identified as slab memory by its page aligned SLABDESC.
+//
+//          Page runs of the HEAPDESC chain are registered in a list of their ENDOFMEM HEAPDESC,
+//          linked through CrumbleFront (next) and CrumbleRear (previous). PageBase and Pages
+//          of the run are copied to the ENDOFMEM HEAPDESC, so that the runs are released on exit
+//          without visiting the memory blocks.
+//
+//          If pMemAlloc() provides zeroed pages, the untouched range of the latest page run of the
+//          HEAPDESC chain is tracked by pZeroBase/pZeroEnd. Fresh LARGEMEM blocks are zeroed entirely.
+//          malloc() reports a block allocated from zeroed memory in pKnownZero, so that calloc()
+//          skips memset().
+//
+//          Emptied page runs and slab pages are retained in a page cache, linked through
+//          pPred/pSucc of a HEAPDESC at the page base, instead of being returned at once.
+//          If the cache grows above _gCdeCfgHeapPageCacheHigh pages, it is trimmed down to
+//          _gCdeCfgHeapPageCacheLow pages. The cache is handed back on exit and if pMemAlloc() fails.
+//
+//          Blocks of CDE_HEAP_LARGE_MIN bytes and above get page runs of their own, outside of the
+//          HEAPDESC chain. The HEAPDESC at the page base is marked LARGEMEM and linked to a separate
+//          list through pPred/pSucc. free() returns the pages immediately.
+//
+//          In Pre-Memory-PEI (fTinyHeap set by the OSIF) memory is taken from a compact heap instead:
+//          page runs that start with TINYDESC, carved into blocks with a TINYHDR boundary tag of
+//          a single granule, without slab pages and page runs of their own.
+//          If HEAPCTRL is found at a different address than pSelf, the PEI core has migrated the
+//          temporary RAM to permanent memory. The compact heap regions are re-registered at the
+//          migrated address and pointers into the former range pCarBase/pCarEnd are translated,
+//          so that blocks allocated in Pre-Memory-PEI remain valid for free() and realloc().
+//
+//          A fixed pool (HEAPPOOL, reserved by _cdeHeapPoolCreate(), SMM) belongs to the driver, that
+//          reserved it. The memory blocks of that driver are taken from a single inalterable page
+//          run of the HEAPDESC chain, without slab pages, LARGEMEM blocks and further pMemAlloc() calls.
+//          FREEMEM blocks of the pool are kept in size class lists of the HEAPPOOL, apart from the
+//          shared ones, so that other drivers in the shared CDE_SERVICES neither take blocks from
+//          the pool nor lose their normal growth. The first fit scan of a size class is skipped,
+//          so that the time of an allocation is bounded: the head of the own size class or
+//          the first block of a higher size class is taken, or the allocation fails.
+//
+#define CDE_HEAP_ALIGN 16                           /* granularity of the block size */
+#define CDE_HEAP_BINS 256                           /* number of free block size classes, 4 per power of two */
+#define CDE_SLAB_CLASSES 8                          /* 16, 32, 48 ... 128 byte slab size classes */
+#define CDE_TINY_ALIGN (2 * sizeof(size_t))         /* granularity of the compact heap, TINYHDR size */
+#ifndef CDE_HEAP_LARGE_MIN
+#   define CDE_HEAP_LARGE_MIN 0x10000               /* minimum size of blocks with page runs of their own */
+#endif//CDE_HEAP_LARGE_MIN
+
+typedef struct _SLABDESC {
+    struct _SLABDESC* pSelf;                        // points to itself, slab page signature
+    unsigned long long  qwMagic;
+#define SLABMEM 0x4D42414C533E3E3EL     /* >>>SLABM */
+#define LARGEMEM 0x454752414C3E3E3EL    /* >>>LARGE */
+    unsigned char fInalterable;
+    struct _SLABDESC* pPred;                        // link to pred. page of the same size class
+    struct _SLABDESC* pSucc;                        // link to succ. page of the same size class
+    unsigned short wSlotSize;
+    unsigned short nSlots;
+    unsigned short nFree;
+    unsigned long long bmFree[4096 / CDE_HEAP_ALIGN / 64];  // bitmap of free slots
+}SLABDESC, * PSLABDESC;
+
+//
+// HEAPCOUNT running counters of the memory suballocator, read by _cdeHeapStats()
+//
+typedef struct _HEAPCOUNT {
+    unsigned long long qwMalloc;                    // malloc() calls, ptr == NULL
+    unsigned long long qwRealloc;                   // realloc() calls, ptr != NULL, size != 0
+    unsigned long long qwFree;                      // free() calls, ptr != NULL, size == 0
+    unsigned long long qwBinFind;                   // size class lookups
+    unsigned long long qwBinScan;                   // FREEMEM blocks examined by the lookups
+    unsigned long long qwPagesAlloc;                // pages taken from pMemAlloc()
+    unsigned long long qwPagesFree;                 // pages returned to pMemFree()
+}HEAPCOUNT;
+
+typedef struct _TINYDESC {
+    struct _TINYDESC* pSelf;                        // points to itself
+    unsigned long long  qwMagic;
+#define TINYMEM 0x4D594E49543E3E3EL     /* >>>TINYM */
+    unsigned char fInalterable;
+    struct _TINYDESC* pSucc;                        // next compact heap region
+    unsigned long Pages;
+}TINYDESC, * PTINYDESC;
+
+typedef struct _TINYHDR {
+    size_t cbSize;                                  // block size including TINYHDR, bit 0: allocated
+    size_t cbPrev;                                  // size of the preceding block, 0 for the first one
+}TINYHDR;
+
+typedef struct _HEAPPOOL {
+    struct _HEAPPOOL* pSucc;                        // next fixed pool
+    void* pOwner;                                   // CDE_APP_IF of the driver, that reserved the pool
+    unsigned char* pBase;                           // address range of the page run of the pool
+    unsigned char* pEnd;
+    unsigned long long bmBins[CDE_HEAP_BINS / 64];  // bitmap of non-empty size classes of the pool
+    HEAPDESC* rgpBin[CDE_HEAP_BINS];                // size class lists of FREEMEM blocks of the pool
+}HEAPPOOL;
+
+typedef struct _HEAPCTRL {
+    unsigned long long bmBins[CDE_HEAP_BINS / 64];  // bitmap of non-empty size classes
+    HEAPDESC* rgpBin[CDE_HEAP_BINS];                // size class lists of FREEMEM blocks
+    SLABDESC* rgpSlab[CDE_SLAB_CLASSES];            // slab pages with free slots
+    SLABDESC* rgpSlabFull[CDE_SLAB_CLASSES];        // slab pages without free slots
+    HEAPDESC* pPageCache;                           // retained page runs, most recently released first
+    unsigned long long qwPageCachePages;            // number of pages in the page cache
+    HEAPDESC* pLarge;                               // LARGEMEM blocks
+    HEAPDESC* pRun;                                 // page runs of the HEAPDESC chain
+    unsigned char fZeroPages;                       // pMemAlloc() provides zeroed pages
+    unsigned char* pZeroBase;                       // untouched, zeroed range of the latest page run
+    unsigned char* pZeroEnd;
+    void* pKnownZero;                               // latest block allocated from zeroed memory, for calloc()
+    struct _CDEARENA* pArena;                       // arenas not yet destroyed
+    HEAPCOUNT Count;                                // running counters
+    void* pSite;                                    // allocation site, set by the Standard C memory functions
+    struct _CDEHEAPPROF* pProf;                     // heap profiler, NULL if not started
+    unsigned char fTinyHeap;                        // allocate from the compact heap, Pre-Memory-PEI
+    TINYDESC* pTiny;                                // compact heap regions
+    unsigned char* pTinyBase;                       // address range of the compact heap regions
+    unsigned char* pTinyEnd;
+    unsigned char* pCarBase;                        // address range of the compact heap regions before migration
+    unsigned char* pCarEnd;
+    void* pSelf;                                    // address of HEAPCTRL when the compact heap was created
+    HEAPPOOL* pPool;                                // fixed pools, bounded time allocation of their drivers
+}HEAPCTRL;
+
+//
+// CDEHEAPSTATS heap statistics, reported by _cdeHeapStats()
+//
+// NOTE:    The running counters are copied from HEAPCTRL, all other fields are
+//          gathered by walking the HEAPDESC chain, the slab pages, the LARGEMEM
+//          list and the page cache. The average scan length of a size class lookup
+//          is Count.qwBinScan / Count.qwBinFind.
+//
+typedef struct _CDEHEAPSTATS {
+    size_t BytesInUse;                              // ALLOCMEM, slab slot and LARGEMEM bytes
+    size_t BlocksInUse;
+    size_t FreeBytes;                               // FREEMEM bytes of the HEAPDESC chain
+    size_t FreeBlocks;
+    size_t LargestFree;                             // largest FREEMEM block
+    size_t Runs;                                    // page runs of the HEAPDESC chain
+    size_t RunPages;
+    size_t SlabPages;
+    size_t SlabSlotsFree;
+    size_t LargeBlocks;
+    size_t LargePages;
+    size_t CachePages;                              // pages retained in the page cache
+    size_t TinyPages;                               // pages of the compact heap
+    HEAPCOUNT Count;
+}CDEHEAPSTATS;
+
+//
+// HEAPWALK callback of _cdeHeapStats(), invoked for each memory block.
+// qwMagic is ALLOCMEM, FREEMEM, SLABMEM (allocated slot), LARGEMEM or TINYMEM (allocated compact heap block).
+// A nonzero return value stops the walk.
+//
+typedef int HEAPWALK(void* pContext, void* ptr, size_t size, unsigned long long qwMagic);
+
+//
+// CDEHEAPPROF allocation site heap profiler
+//
+// NOTE:    Started by _cdeHeapProfStart(), that takes the profiler memory from pMemAlloc().
+//          Each call of _cdeMemRealloc()/_cdeMemAlignedRealloc() is recorded in a ring of
+//          CDEHEAPPROFREC with its allocation site, size and TSC, and accumulated per site
+//          in CDEHEAPSITE. The allocation site is the caller of the Standard C memory function,
+//          passed in HEAPCTRL.pSite, otherwise the caller of the suballocator.
+//          Live blocks are tracked in a hash table, to account freed bytes to their site.
+//          Records that don't fit into the site or live block table are counted in qwLost.
+//          _cdeHeapProfDump() writes the per site histogram and the ring as text lines.
+//
+#ifndef CDE_HEAPPROF_SITES
+#   define CDE_HEAPPROF_SITES 256                   /* number of allocation sites, power of two */
+#endif//CDE_HEAPPROF_SITES
+#ifndef CDE_HEAPPROF_LIVE
+#   define CDE_HEAPPROF_LIVE 8192                   /* number of tracked live blocks, power of two */
+#endif//CDE_HEAPPROF_LIVE
+
+typedef struct _CDEHEAPPROFREC {
+    void* pSite;
+    void* ptr;                                      // input pointer
+    void* pRet;                                     // returned pointer
+    size_t size;                                    // requested size, 0 for free()
+    unsigned long long qwTsc;                       // TSC on entry
+    unsigned long long qwTicks;                     // TSC ticks spent in the suballocator
+}CDEHEAPPROFREC;
+
+typedef struct _CDEHEAPSITE {
+    void* pSite;                                    // NULL for unused entries
+    unsigned long long qwCount;                     // calls
+    unsigned long long qwBytes;                     // bytes requested
+    unsigned long long qwLiveBytes;                 // bytes allocated and not yet freed
+    unsigned long long qwTicks;                     // TSC ticks spent in the suballocator
+}CDEHEAPSITE;
+
+typedef struct _CDEHEAPLIVE {
+    void* ptr;                                      // NULL for unused entries
+    size_t size;
+    CDEHEAPSITE* pSite;
+}CDEHEAPLIVE;
+
+typedef struct _CDEHEAPPROF {
+    unsigned long Pages;                            // size of the profiler memory
+    unsigned nRing;                                 // number of ring records
+    unsigned long long qwRecords;                   // total number of records
+    unsigned long long qwLost;                      // records not accounted to a site or live block
+    CDEHEAPPROFREC* pRing;
+    CDEHEAPSITE rgSite[CDE_HEAPPROF_SITES];
+    CDEHEAPLIVE rgLive[CDE_HEAPPROF_LIVE];
+}CDEHEAPPROF;
+
+//
+// CDEARENA arena (bump) allocator
+//
+// NOTE:    An arena is a list of page chunks, each starting with a HEAPDESC marked ARENAMEM.
+//          The chunks are linked through pSucc. CDEARENA itself resides in the first chunk.
+//          Memory is taken from the current chunk by incrementing pBump and is released
+//          altogether by _cdeArenaReset() and _cdeArenaDestroy().
+//          Arenas not destroyed by the application are destroyed on exit.
+//
+typedef struct _CDEARENA {
+    unsigned long long qwMagic;
+#define ARENAMEM 0x414E4552413E3E3EL    /* >>>ARENA */
+    struct _CDEARENA* pPred;                        // list of arenas in HEAPCTRL
+    struct _CDEARENA* pSucc;
+    HEAPDESC* pFirst;                               // first chunk, holds CDEARENA
+    HEAPDESC* pChunk;                               // current chunk
+    unsigned char* pBump;                           // next free byte in the current chunk
+    unsigned char* pLimit;                          // end of the current chunk
+    unsigned long nChunkPages;                      // default number of pages per chunk
+}CDEARENA;
+
+//
+// sort parameter of qsort(), qsort_s() and the sort engines
+//
+typedef struct _CDESORTPARM {
+    int (*pfnCmp)(const void*, const void*);        // qsort() compare function...
+    int (*pfnCmpCtx)(void*, const void*, const void*);// ... or qsort_s() compare function with context
+    void* pContext;
+    size_t width;
+    void (*pfnSwap)(void* p1, void* p2, size_t width);// element swap, selected by width
+}CDESORTPARM;
+
 
 #define DFL (0 << 0)                /* default preset */
 #define PIP (1 << 0)                /* fPointerIsParm:1;       /*filepointer/memorypointer */
@@ -247,6 +497,15 @@ typedef struct _ROMPARM_WCSSTRPBRKSPN {
     unsigned char fWide;
 }ROMPARM_WCSSTRPBRKSPN;
 
+//
+// character set of the str/wcs--pbrk/spn/tok()-family, built once per call
+//
+typedef struct _CDECHARSET {
+    unsigned int rgBitmap[256 / 32];                // one bit per character 0x00..0xFF
+    const unsigned short* pSetHi;                   // wide set, scanned for characters above 0xFF only...
+    unsigned short wMinHi, wMaxHi;                  // ... within the range of the set characters above 0xFF
+}CDECHARSET;
+
 typedef struct _ROMPARM_MEMSTRXCMP {
     unsigned char fForceToDataSeg;        /*always 1*/
     unsigned char fCountIsParm;
@@ -365,6 +624,106 @@ MEMREALLOC(
     IN HEAPDESC* pHeapStart
     );
 
+typedef
+void*
+MEMALIGNEDREALLOC(
+    CDE_APP_IF* pCdeAppIf,
+    IN void* ptr,   /* input pointer for realloc */
+    IN size_t size, /*  input size for realloc*/
+    IN size_t alignment, /* power of two */
+    IN HEAPDESC* pHeapStart
+    );
+
+typedef
+void
+MEMSIZEDFREE(
+    CDE_APP_IF* pCdeAppIf,
+    IN void* ptr,
+    IN size_t size, /* size passed to malloc() */
+    IN HEAPDESC* pHeapStart
+    );
+
+typedef
+void
+MEMRELEASE(
+    CDE_APP_IF* pCdeAppIf,
+    IN HEAPDESC* pHeapStart
+    );
+
+typedef
+int
+HEAPPROFSTART(
+    CDE_APP_IF* pCdeAppIf,
+    IN unsigned nRing           /* number of ring records */
+    );
+
+typedef
+void
+HEAPPROFSTOP(
+    CDE_APP_IF* pCdeAppIf
+    );
+
+typedef
+int
+HEAPPROFDUMP(
+    CDE_APP_IF* pCdeAppIf,
+    IN unsigned (*pfnWriteStr)(char* szLine),
+    IN int fRing                /* write the ring records too */
+    );
+
+typedef
+int
+HEAPPOOLCREATE(
+    CDE_APP_IF* pCdeAppIf,
+    IN unsigned long Pages,
+    IN HEAPDESC* pHeapStart
+    );
+
+typedef
+void
+HEAPRESTART(
+    CDE_APP_IF* pCdeAppIf,
+    IN HEAPDESC* pHeapStart
+    );
+
+typedef
+int
+HEAPSTATS(
+    CDE_APP_IF* pCdeAppIf,
+    OUT CDEHEAPSTATS* pStats,   /* optional */
+    IN HEAPWALK* pfnWalk,       /* optional */
+    IN void* pContext
+    );
+
+typedef
+CDEARENA*
+ARENACREATE(
+    CDE_APP_IF* pCdeAppIf,
+    IN size_t nChunkSize    /* default size of page chunks, 0 for one page */
+    );
+
+typedef
+void*
+ARENAALLOC(
+    CDE_APP_IF* pCdeAppIf,
+    IN CDEARENA* pArena,
+    IN size_t size
+    );
+
+typedef
+void
+ARENARESET(
+    CDE_APP_IF* pCdeAppIf,
+    IN CDEARENA* pArena
+    );
+
+typedef
+void
+ARENADESTROY(
+    CDE_APP_IF* pCdeAppIf,
+    IN CDEARENA* pArena
+    );
+
 typedef void* MEMSTRXCPY(
     IN int preset,
     OUT void* pszDest,
@@ -587,9 +946,32 @@ typedef struct _CDE_SERVICES {
     //void* pDIAGR4FX1; // R4FX: reserved for furure extentions
     //void* pDIAGR4FX2; // R4FX: reserved for furure extentions
     //void* pDIAGR4FX3; // R4FX: reserved for furure extentions
+//
+// CDE_SERVICES_VER_MINOR 1 extentions
+//
+    HEAPCTRL HeapCtrl;                      // size class lists of the suballocator
+    ARENACREATE* pArenaCreate;
+    ARENAALLOC* pArenaAlloc;
+    ARENARESET* pArenaReset;
+    ARENADESTROY* pArenaDestroy;
+    MEMALIGNEDREALLOC* pMemAlignedRealloc;
+    MEMSIZEDFREE* pMemSizedFree;
 
 }CDE_SERVICES;
 
+//
+// CDE_SERVICES version
+// NOTE:    CDE_SERVICES is provided by separately built CdeServices drivers in DXE, SMM and PEI.
+//          New members are appended only, and wVerMinor is incremented. A change of
+//          wVerMajor breaks the layout of existing members and is rejected by the entry points.
+//          Members of CDE_SERVICES_VER_MINOR 1 (HeapCtrl, pArenaXxx, pMemAlignedRealloc,
+//          pMemSizedFree) must not be accessed, if CDE_SERVICES_HEAPCTRL() is FALSE.
+//
+#define CDE_SERVICES_VER_MAJOR 0
+#define CDE_SERVICES_VER_MINOR 1
+#define CDE_SERVICES_HEAPCTRL(pCdeServices) (CDE_SERVICES_VER_MAJOR == (pCdeServices)->wVerMajor && 1 <= (pCdeServices)->wVerMinor)
+#define CDE_SET_HEAPSITE(pCdeServices, pSiteAddr) (CDE_SERVICES_HEAPCTRL(pCdeServices) ? (void)((pCdeServices)->HeapCtrl.pSite = (pSiteAddr)) : (void)0)
+
 extern void _CdeMemPutWChar(int c, void** ppDest);
 extern void _CdeMemPutNada(int c, void** ppDest);
 extern void _CdeMemPutChar(int c, void** ppDest);
@@ -659,6 +1041,25 @@ typedef struct tagCDEFILE {
     size_t gapsize;                             // gap size     /*KG20220418 gap of non-initialized disk space*/
 }CDEFILE;
 
+//
+// character fast path for fgetc()/getc()/fputc()/putc(): the character is taken from / stored to CDEFILE.Buffer
+// directly, if fread()/fwrite() would do the same without buffer refill, buffer flush, CR/LF translation,
+// CTRL-Z detection, append positioning or flushing stdout/stderr on each character
+//
+#define CDE_FGETC_INBUF(f)  (                                                                       \
+        (f)->bidx < (f)->bvld && (f)->bidx < (f)->bufPosEOF && FALSE == (f)->fCtrlZ                 \
+        && O_WRONLY != ((f)->openmode & (O_RDONLY | O_WRONLY | O_RDWR))                             \
+        && (0 == ((f)->openmode & O_TEXT)                                                           \
+            || (0 == (f)->cntSkipCtrlZChk                                                           \
+                && '\r' != (f)->Buffer[(f)->bidx] && 0x1A != (f)->Buffer[(f)->bidx])))
+
+#define CDE_FPUTC_INBUF(f,c) (                                                                      \
+        NULL != (f)->Buffer && (f)->bidx + 1 < (f)->bsiz                                            \
+        && O_RDONLY != ((f)->openmode & (O_RDONLY | O_WRONLY | O_RDWR))                             \
+        && 0 == ((f)->openmode & O_APPEND)                                                          \
+        && (0 == ((f)->openmode & (O_CDESTDMASK | O_CDEREOPEN)) || ((f)->openmode & O_CDEREDIR))    \
+        && (0 == ((f)->openmode & O_TEXT) || '\n' != (c)))
+
 #ifdef OS_EFI
 typedef struct tagCDEFSVOLUME {
     EFI_HANDLE hSimpleFileSystem;
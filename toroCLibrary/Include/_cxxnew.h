@@ -0,0 +1,69 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    _cxxnew.h
+
+Abstract:
+
+    Definitions of the C++ new and delete operators, replacing Microsoft <new>
+    https://en.cppreference.com/w/cpp/memory/new/operator_new
+    https://en.cppreference.com/w/cpp/memory/new/operator_delete
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#ifndef _CXXNEW_H_
+#define _CXXNEW_H_
+#include <stddef.h>
+#include <stdlib.h>
+#include <intrin.h>
+
+#ifndef __NOTHROW_T_DEFINED
+#define __NOTHROW_T_DEFINED
+namespace std {
+    struct nothrow_t {
+        explicit nothrow_t() = default;
+    };
+    extern nothrow_t const nothrow;
+}
+#endif//__NOTHROW_T_DEFINED
+
+namespace std {
+    enum class align_val_t : size_t {};
+}
+
+void* operator new(size_t size);
+void* operator new(size_t size, std::align_val_t alignment);
+void* operator new(size_t size, const std::nothrow_t&) noexcept;
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept;
+void* operator new[](size_t size);
+void* operator new[](size_t size, std::align_val_t alignment);
+void* operator new[](size_t size, const std::nothrow_t&) noexcept;
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept;
+
+void operator delete(void* ptr) noexcept;
+void operator delete(void* ptr, size_t size) noexcept;
+void operator delete(void* ptr, std::align_val_t) noexcept;
+void operator delete(void* ptr, size_t size, std::align_val_t) noexcept;
+void operator delete(void* ptr, const std::nothrow_t&) noexcept;
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept;
+void operator delete[](void* ptr) noexcept;
+void operator delete[](void* ptr, size_t size) noexcept;
+void operator delete[](void* ptr, std::align_val_t) noexcept;
+void operator delete[](void* ptr, size_t size, std::align_val_t) noexcept;
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept;
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept;
+
+extern "C" void* __cdeCxxNew(size_t size, size_t alignment, void* pSite);
+extern "C" void __cdeCxxDelete(void* ptr, size_t size, size_t alignment, void* pSite);
+
+#endif//_CXXNEW_H_
@@ -0,0 +1,27 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    _gCdeCfgHeapPageCacheLow.c
+
+Abstract:
+
+    Runtimeswitch.
+    Number of pages kept in the memory suballocator page cache, when trimmed
+    after exceeding _gCdeCfgHeapPageCacheHigh.
+
+    NOTE:   This is the default setting. It could be overwritten at runtime or overloaded
+            with a linked .OBJ module that provides unsigned long _gCdeCfgHeapPageCacheLow = n
+
+Author:
+
+    Kilian Kegel
+
+--*/
+unsigned long _gCdeCfgHeapPageCacheLow = 64;
@@ -0,0 +1,30 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    _gCdeCfgSmmPoolPages.c
+
+Abstract:
+
+    Buildtime switch.
+    Number of SMRAM pages reserved for the fixed memory pool of the SMM memory suballocator.
+    If nonzero, the pool is reserved at SMM driver entry and all memory allocations of
+    the driver are served from it in bounded time, without further SMRAM page allocation.
+    Other SMM drivers are not affected.
+    0 disables the fixed pool.
+
+    NOTE:   This is the default setting. It could be overloaded
+            with a linked .OBJ module that provides unsigned long _gCdeCfgSmmPoolPages = n
+
+Author:
+
+    Kilian Kegel
+
+--*/
+unsigned long _gCdeCfgSmmPoolPages = 0;
@@ -0,0 +1,210 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    __cdeIntroSort.c
+
+Abstract:
+
+    CDE internal sort engine for qsort() and qsort_s()
+
+    Introsort: median-of-three quicksort, heapsort when the recursion depth
+    exceeds 2 * log2(n), insertion sort for partitions up to INSERTIONMAX
+    elements. The smaller partition is sorted recursively, the larger one
+    iteratively, so the stack depth is bounded by log2(n).
+
+    The element swap is selected once per call: 4, 8 and 16 byte elements
+    (int, pointer, long long, double, 2 pointer structures) are swapped with
+    integer moves, other widths size_t word-wise.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+
+#define INSERTIONMAX 16
+#define CMP(p, a, b) (NULL != (p)->pfnCmpCtx ? (*(p)->pfnCmpCtx)((p)->pContext, a, b) : (*(p)->pfnCmp)(a, b))
+#define SWAP(p, a, b) (*(p)->pfnSwap)(a, b, (p)->width)
+
+static void __swap4(void* p1, void* p2, size_t width) {
+    unsigned int t = *(unsigned int*)p1;
+
+    *(unsigned int*)p1 = *(unsigned int*)p2;
+    *(unsigned int*)p2 = t;
+}
+
+static void __swap8(void* p1, void* p2, size_t width) {
+    unsigned long long t = *(unsigned long long*)p1;
+
+    *(unsigned long long*)p1 = *(unsigned long long*)p2;
+    *(unsigned long long*)p2 = t;
+}
+
+static void __swap16(void* p1, void* p2, size_t width) {
+    unsigned long long t0 = ((unsigned long long*)p1)[0], t1 = ((unsigned long long*)p1)[1];
+
+    ((unsigned long long*)p1)[0] = ((unsigned long long*)p2)[0];
+    ((unsigned long long*)p1)[1] = ((unsigned long long*)p2)[1];
+    ((unsigned long long*)p2)[0] = t0;
+    ((unsigned long long*)p2)[1] = t1;
+}
+
+static void __swapN(void* p1, void* p2, size_t width) {
+    unsigned char* b1 = p1;
+    unsigned char* b2 = p2;
+    size_t i, t;
+    unsigned char c;
+
+    for (i = 0; i + sizeof(size_t) <= width; i += sizeof(size_t)) {
+        t = *(size_t*)&b1[i];
+        *(size_t*)&b1[i] = *(size_t*)&b2[i];
+        *(size_t*)&b2[i] = t;
+    }
+
+    for (/* i */; i < width; i++)
+        c = b1[i], b1[i] = b2[i], b2[i] = c;
+}
+
+/** __insertionSort()
+**/
+static void __insertionSort(unsigned char* base, size_t num, CDESORTPARM* pParm) {
+    size_t width = pParm->width;
+    unsigned char* pEnd = base + num * width;
+    unsigned char* p;
+    unsigned char* q;
+
+    for (p = base + width; p < pEnd; p += width)
+        for (q = p; q > base && CMP(pParm, q - width, q) > 0; q -= width)
+            SWAP(pParm, q - width, q);
+}
+
+/** __heapSort() - fallback for degenerated partitions
+**/
+static void __heapSort(unsigned char* base, size_t num, CDESORTPARM* pParm) {
+    size_t width = pParm->width;
+    size_t i, root, child, n;
+
+    for (i = num / 2; i-- > 0; /* */) {                 // build the max heap...
+        for (root = i; (child = 2 * root + 1) < num; root = child) {
+            if (child + 1 < num && CMP(pParm, base + child * width, base + (child + 1) * width) < 0)
+                child++;
+            if (CMP(pParm, base + root * width, base + child * width) >= 0)
+                break;
+            SWAP(pParm, base + root * width, base + child * width);
+        }
+    }
+
+    for (n = num; n-- > 1; /* */) {                     // ... move the maximum to the end
+        SWAP(pParm, base, base + n * width);
+        for (root = 0; (child = 2 * root + 1) < n; root = child) {
+            if (child + 1 < n && CMP(pParm, base + child * width, base + (child + 1) * width) < 0)
+                child++;
+            if (CMP(pParm, base + root * width, base + child * width) >= 0)
+                break;
+            SWAP(pParm, base + root * width, base + child * width);
+        }
+    }
+}
+
+/** __introSort()
+**/
+static void __introSort(unsigned char* base, size_t num, CDESORTPARM* pParm, int depth) {
+    size_t width = pParm->width;
+    unsigned char* lo;
+    unsigned char* mid;
+    unsigned char* hi;
+    unsigned char* i;
+    unsigned char* j;
+    size_t nLeft, nRight;
+
+    while (num > INSERTIONMAX) {
+
+        if (0 == depth--) {
+            __heapSort(base, num, pParm);
+            return;
+        }
+
+        //
+        // median of three to lo, lo <= pivot <= hi
+        //
+        lo = base;
+        mid = base + (num / 2) * width;
+        hi = base + (num - 1) * width;
+
+        if (CMP(pParm, mid, lo) < 0)
+            SWAP(pParm, mid, lo);
+        if (CMP(pParm, hi, mid) < 0) {
+            SWAP(pParm, hi, mid);
+            if (CMP(pParm, mid, lo) < 0)
+                SWAP(pParm, mid, lo);
+        }
+        SWAP(pParm, lo, mid);
+
+        //
+        // Hoare partition, the pivot at lo and the maximum at hi are the sentinels
+        //
+        i = lo + width;
+        j = hi;
+
+        for (;;) {
+            while (CMP(pParm, i, lo) < 0)
+                i += width;
+            while (CMP(pParm, j, lo) > 0)
+                j -= width;
+            if (i >= j)
+                break;
+            SWAP(pParm, i, j);
+            i += width;
+            j -= width;
+        }
+        SWAP(pParm, lo, j);
+
+        nLeft = (size_t)(j - base) / width;
+        nRight = num - nLeft - 1;
+
+        if (nLeft < nRight) {
+            __introSort(base, nLeft, pParm, depth);
+            base = j + width;
+            num = nRight;
+        }
+        else {
+            __introSort(j + width, nRight, pParm, depth);
+            num = nLeft;
+        }
+    }
+
+    __insertionSort(base, num, pParm);
+}
+
+/** __cdeIntroSort() - sort num elements of pParm->width bytes
+
+    pParm provides the compare function and the context, the swap function
+    is selected here.
+**/
+void __cdeIntroSort(void* base, size_t num, CDESORTPARM* pParm) {
+    int depth = 0;
+    size_t n;
+
+    if (num < 2 || 0 == pParm->width)
+        return;
+
+    switch (pParm->width) {
+        case 4:  pParm->pfnSwap = __swap4; break;
+        case 8:  pParm->pfnSwap = __swap8; break;
+        case 16: pParm->pfnSwap = __swap16; break;
+        default: pParm->pfnSwap = __swapN; break;
+    }
+
+    for (n = num; n > 1; n >>= 1)
+        depth += 2;
+
+    __introSort(base, num, pParm, depth);
+}
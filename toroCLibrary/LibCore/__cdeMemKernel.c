@@ -0,0 +1,284 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    __cdeMemKernel.c
+
+Abstract:
+
+    CDE internal memory copy and fill kernels for memcpy(), memmove(), memset(),
+    wmemcpy(), wmemset() and _cdeMemStrxCpy()
+
+    Size tiers:
+        0..16 bytes         jump table, two overlapping moves
+        17..64 bytes        SSE2 16 byte moves, (x64), size_t word moves otherwise
+        65.. bytes          AVX 32 byte moves, if enabled by the OS (XCR0)
+        2048.. bytes        rep movsb / rep stosb, if ERMS is reported by CPUID
+
+    The tail (head) of a forward (backward) copy is loaded before the loop and
+    stored with an overlapping move at the end, so that overlapping buffers are
+    handled correctly.
+
+    NOTE:   32Bit builds (PEI) and builds with CDE_MEMKERNEL_PORTABLE defined use
+            the size_t word moves only, without CPUID.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stddef.h>
+#if defined(_M_X64) && !defined(CDE_MEMKERNEL_PORTABLE)
+#   define MEMKERNEL_X64
+#   include <intrin.h>
+#   include <immintrin.h>
+#endif//defined(_M_X64) && !defined(CDE_MEMKERNEL_PORTABLE)
+
+#define PBYTE unsigned char*
+#define ERMSMIN 2048                                    /* min. size for rep movsb / rep stosb */
+#define LD(t,p) (*(const t*)(p))
+#define ST(t,p,v) (*(t*)(p) = (v))
+
+#ifdef MEMKERNEL_X64
+
+#define MEMFEAT_VALID   1
+#define MEMFEAT_AVX     2
+#define MEMFEAT_ERMS    4
+
+static unsigned char __cdeMemFeat;                      // NOTE: not writeable in XIP PEI, detected again
+
+/** __memFeatures() - get CPU features of the memory kernels
+**/
+static unsigned __memFeatures(void) {
+    unsigned f = __cdeMemFeat;
+    int r[4];
+
+    if (0 == f) {
+
+        f = MEMFEAT_VALID;
+
+        __cpuid(r, 0);
+        if (r[0] >= 7) {
+            __cpuidex(r, 7, 0);
+            if (r[1] & (1 << 9))                        // EBX.ERMS
+                f |= MEMFEAT_ERMS;
+        }
+
+        __cpuid(r, 1);
+        if ((r[2] & (1 << 27)) && (r[2] & (1 << 28)))   // ECX.OSXSAVE, ECX.AVX
+            if (6 == (_xgetbv(0) & 6))                  // XMM and YMM state enabled
+                f |= MEMFEAT_AVX;
+
+        __cdeMemFeat = (unsigned char)f;
+    }
+
+    return f;
+}
+#endif//MEMKERNEL_X64
+
+/** __memSmall() - copy 0..16 bytes, all loads precede the stores
+**/
+static void __memSmall(PBYTE d, const PBYTE s, size_t n) {
+
+    switch (n) {
+        case 16: case 15: case 14: case 13: case 12: case 11: case 10: case 9: case 8: {
+            unsigned long long h = LD(unsigned long long, s), t = LD(unsigned long long, s + n - 8);
+            ST(unsigned long long, d, h);
+            ST(unsigned long long, d + n - 8, t);
+            break;
+        }
+        case 7: case 6: case 5: case 4: {
+            unsigned int h = LD(unsigned int, s), t = LD(unsigned int, s + n - 4);
+            ST(unsigned int, d, h);
+            ST(unsigned int, d + n - 4, t);
+            break;
+        }
+        case 3: case 2: {
+            unsigned short h = LD(unsigned short, s), t = LD(unsigned short, s + n - 2);
+            ST(unsigned short, d, h);
+            ST(unsigned short, d + n - 2, t);
+            break;
+        }
+        case 1:
+            *d = *s;
+            break;
+        default:
+            break;
+    }
+}
+
+/** __cdeMemCpyFwd() - copy n bytes, from lower to higher addresses
+
+    Handles overlapping buffers with d below s.
+**/
+void* __cdeMemCpyFwd(void* pDst, const void* pSrc, size_t n) {
+    PBYTE d = pDst;
+    const PBYTE s = (const PBYTE)pSrc;
+    size_t i;
+
+    if (n <= 16) {
+        __memSmall(d, s, n);
+        return pDst;
+    }
+
+#ifdef MEMKERNEL_X64
+    do {
+        unsigned f = __memFeatures();
+
+        if (n >= ERMSMIN && (f & MEMFEAT_ERMS)) {
+            __movsb(d, s, n);
+            break;
+        }
+
+        if (n > 64 && (f & MEMFEAT_AVX)) {
+            __m256i t = _mm256_loadu_si256((const __m256i*)(s + n - 32));
+
+            for (i = 0; i + 32 < n; i += 32)
+                _mm256_storeu_si256((__m256i*)(d + i), _mm256_loadu_si256((const __m256i*)(s + i)));
+            _mm256_storeu_si256((__m256i*)(d + n - 32), t);
+            _mm256_zeroupper();
+            break;
+        }
+
+        if (1) {
+            __m128i t = _mm_loadu_si128((const __m128i*)(s + n - 16));
+
+            for (i = 0; i + 16 < n; i += 16)
+                _mm_storeu_si128((__m128i*)(d + i), _mm_loadu_si128((const __m128i*)(s + i)));
+            _mm_storeu_si128((__m128i*)(d + n - 16), t);
+        }
+    } while (0);
+#else //MEMKERNEL_X64
+    if (1) {
+        size_t t = LD(size_t, s + n - sizeof(size_t));
+
+        for (i = 0; i + sizeof(size_t) < n; i += sizeof(size_t))
+            ST(size_t, d + i, LD(size_t, s + i));
+        ST(size_t, d + n - sizeof(size_t), t);
+    }
+#endif//MEMKERNEL_X64
+
+    return pDst;
+}
+
+/** __cdeMemCpyBwd() - copy n bytes, from higher to lower addresses
+
+    Handles overlapping buffers with d above s.
+**/
+void* __cdeMemCpyBwd(void* pDst, const void* pSrc, size_t n) {
+    PBYTE d = pDst;
+    const PBYTE s = (const PBYTE)pSrc;
+    size_t i;
+
+    if (n <= 16) {
+        __memSmall(d, s, n);
+        return pDst;
+    }
+
+#ifdef MEMKERNEL_X64
+    do {
+        unsigned f = __memFeatures();
+
+        if (n > 64 && (f & MEMFEAT_AVX)) {
+            __m256i h = _mm256_loadu_si256((const __m256i*)s);
+
+            for (i = n; i > 32; i -= 32)
+                _mm256_storeu_si256((__m256i*)(d + i - 32), _mm256_loadu_si256((const __m256i*)(s + i - 32)));
+            _mm256_storeu_si256((__m256i*)d, h);
+            _mm256_zeroupper();
+            break;
+        }
+
+        if (1) {
+            __m128i h = _mm_loadu_si128((const __m128i*)s);
+
+            for (i = n; i > 16; i -= 16)
+                _mm_storeu_si128((__m128i*)(d + i - 16), _mm_loadu_si128((const __m128i*)(s + i - 16)));
+            _mm_storeu_si128((__m128i*)d, h);
+        }
+    } while (0);
+#else //MEMKERNEL_X64
+    if (1) {
+        size_t h = LD(size_t, s);
+
+        for (i = n; i > sizeof(size_t); i -= sizeof(size_t))
+            ST(size_t, d + i - sizeof(size_t), LD(size_t, s + i - sizeof(size_t)));
+        ST(size_t, d, h);
+    }
+#endif//MEMKERNEL_X64
+
+    return pDst;
+}
+
+/** __cdeMemFill() - fill n bytes with a pattern
+
+    qwFill holds the fill pattern replicated to 8 bytes, the period of the pattern
+    is 1 or 2 bytes (wmemset()). With a 2 byte period n is even.
+**/
+void* __cdeMemFill(void* pDst, unsigned long long qwFill, size_t n) {
+    PBYTE d = pDst;
+    size_t i;
+
+    switch (n < 16 ? n : 16) {
+        case 16:
+            break;
+        case 15: case 14: case 13: case 12: case 11: case 10: case 9: case 8:
+            ST(unsigned long long, d, qwFill);
+            ST(unsigned long long, d + n - 8, qwFill);
+            return pDst;
+        case 7: case 6: case 5: case 4:
+            ST(unsigned int, d, (unsigned int)qwFill);
+            ST(unsigned int, d + n - 4, (unsigned int)qwFill);
+            return pDst;
+        case 3: case 2:
+            ST(unsigned short, d, (unsigned short)qwFill);
+            ST(unsigned short, d + n - 2, (unsigned short)qwFill);
+            return pDst;
+        case 1:
+            *d = (unsigned char)qwFill;
+            return pDst;
+        default:
+            return pDst;
+    }
+
+#ifdef MEMKERNEL_X64
+    do {
+        unsigned f = __memFeatures();
+
+        if (n >= ERMSMIN && (f & MEMFEAT_ERMS) && qwFill == (qwFill & 0xFF) * 0x0101010101010101ULL) {
+            __stosb(d, (unsigned char)qwFill, n);
+            break;
+        }
+
+        if (n > 64 && (f & MEMFEAT_AVX)) {
+            __m256i v = _mm256_set1_epi64x((long long)qwFill);
+
+            for (i = 0; i + 32 < n; i += 32)
+                _mm256_storeu_si256((__m256i*)(d + i), v);
+            _mm256_storeu_si256((__m256i*)(d + n - 32), v);
+            _mm256_zeroupper();
+            break;
+        }
+
+        if (1) {
+            __m128i v = _mm_set1_epi64x((long long)qwFill);
+
+            for (i = 0; i + 16 < n; i += 16)
+                _mm_storeu_si128((__m128i*)(d + i), v);
+            _mm_storeu_si128((__m128i*)(d + n - 16), v);
+        }
+    } while (0);
+#else //MEMKERNEL_X64
+    for (i = 0; i + 8 < n; i += 8)
+        ST(unsigned long long, d + i, qwFill);
+    ST(unsigned long long, d + n - 8, qwFill);
+#endif//MEMKERNEL_X64
+
+    return pDst;
+}
@@ -0,0 +1,224 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    __cdeMemMem.c
+
+Abstract:
+
+    CDE internal substring search for strstr(), wcsstr() and memmem()
+
+    Needles of 2..32 elements (x64): SSE2 prefilter, that compares the first
+    and the last needle element at 16 byte of haystack positions at once,
+    candidates are verified with the mismatch kernel.
+    Longer needles, 32Bit builds and CDE_MEMKERNEL_PORTABLE: Two-Way algorithm
+    (Crochemore/Perrin), linear time, constant space.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stddef.h>
+#if defined(_M_X64) && !defined(CDE_MEMKERNEL_PORTABLE)
+#   define MEMMEM_SSE2
+#   include <intrin.h>
+#   include <emmintrin.h>
+#endif//defined(_M_X64) && !defined(CDE_MEMKERNEL_PORTABLE)
+
+#define PBYTE unsigned char*
+#define EL(p,i) (fWide ? ((const unsigned short*)(p))[i] : ((const unsigned char*)(p))[i])
+#define PREFILTERMAX 32                                 /* max. needle length for the SSE2 prefilter */
+
+extern void* __cdeMemChr(const void* s, int c, size_t n);
+extern void* __cdeWMemChr(const unsigned short* s, unsigned short c, size_t n);
+extern size_t __cdeMemMismatch(const void* s1, const void* s2, size_t n, int fWide);
+
+/** __maxSuf() - maximal suffix of the needle, for the ordering selected by fRev
+
+    @retval start of the maximal suffix - 1, period in *pPer
+**/
+static ptrdiff_t __maxSuf(const unsigned char* x, size_t m, int fWide, int fRev, size_t* pPer) {
+    ptrdiff_t ms = -1;
+    size_t j = 0, k = 1, p = 1;
+    unsigned a, b;
+
+    while (j + k < m) {
+
+        a = EL(x, j + k);
+        b = EL(x, ms + k);
+
+        if (fRev ? a > b : a < b) {
+            j += k;
+            k = 1;
+            p = j - ms;
+        }
+        else if (a == b) {
+            if (k != p)
+                k++;
+            else {
+                j += p;
+                k = 1;
+            }
+        }
+        else {
+            ms = j++;
+            k = p = 1;
+        }
+    }
+
+    *pPer = p;
+    return ms;
+}
+
+/** __twoWay() - Two-Way string matching, m >= 1
+
+    @retval index of the first match, (size_t)-1 if not found
+**/
+static size_t __twoWay(const unsigned char* y, size_t n, const unsigned char* x, size_t m, int fWide) {
+    size_t nElem = fWide ? 2 : 1;
+    size_t per, per2, j = 0;
+    ptrdiff_t ell, ell2, i, memory = -1;
+
+    ell = __maxSuf(x, m, fWide, 0, &per);
+    ell2 = __maxSuf(x, m, fWide, 1, &per2);
+
+    if (ell2 > ell) {
+        ell = ell2;
+        per = per2;
+    }
+
+    if (per + ell + 1 <= m && __cdeMemMismatch(x, x + per * nElem, ell + 1, fWide) == (size_t)(ell + 1)) {
+
+        //
+        // periodic needle, remember the matched prefix of the period
+        //
+        while (j + m <= n) {
+
+            i = (ell > memory ? ell : memory) + 1;
+            while ((size_t)i < m && EL(x, i) == EL(y, i + j))
+                i++;
+
+            if ((size_t)i >= m) {
+                i = ell;
+                while (i > memory && EL(x, i) == EL(y, i + j))
+                    i--;
+                if (i <= memory)
+                    return j;
+                j += per;
+                memory = m - per - 1;
+            }
+            else {
+                j += i - ell;
+                memory = -1;
+            }
+        }
+    }
+    else {
+
+        per = ((size_t)(ell + 1) > m - ell - 1 ? (size_t)(ell + 1) : m - ell - 1) + 1;
+
+        while (j + m <= n) {
+
+            i = ell + 1;
+            while ((size_t)i < m && EL(x, i) == EL(y, i + j))
+                i++;
+
+            if ((size_t)i >= m) {
+                i = ell;
+                while (i >= 0 && EL(x, i) == EL(y, i + j))
+                    i--;
+                if (i < 0)
+                    return j;
+                j += per;
+            }
+            else
+                j += i - ell;
+        }
+    }
+
+    return (size_t)-1;
+}
+
+#ifdef MEMMEM_SSE2
+/** __prefilter() - SSE2 first/last element filter, 2 <= m <= PREFILTERMAX
+
+    @retval index of the first match, (size_t)-1 if not found
+**/
+static size_t __prefilter(const unsigned char* y, size_t n, const unsigned char* x, size_t m, int fWide) {
+    size_t nElem = fWide ? 2 : 1;
+    size_t nStep = 16 / nElem;
+    size_t i = 0, pos;
+    __m128i vF = fWide ? _mm_set1_epi16((short)EL(x, 0)) : _mm_set1_epi8((char)EL(x, 0));
+    __m128i vL = fWide ? _mm_set1_epi16((short)EL(x, m - 1)) : _mm_set1_epi8((char)EL(x, m - 1));
+    __m128i b1, b2;
+    unsigned long k;
+    unsigned mask;
+
+    for (/* i */; i + m - 1 + nStep <= n; i += nStep) {
+
+        b1 = _mm_loadu_si128((const __m128i*)(y + i * nElem));
+        b2 = _mm_loadu_si128((const __m128i*)(y + (i + m - 1) * nElem));
+
+        if (fWide)
+            mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(b1, vF), _mm_cmpeq_epi16(b2, vL)));
+        else
+            mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(b1, vF), _mm_cmpeq_epi8(b2, vL)));
+
+        while (0 != mask) {
+
+            _BitScanForward(&k, mask);
+            pos = i + k / nElem;
+
+            if (m - 2 == __cdeMemMismatch(y + (pos + 1) * nElem, x + nElem, m - 2, fWide))
+                return pos;
+
+            mask &= ~((fWide ? 3U : 1U) << k);
+        }
+    }
+
+    for (/* i */; i + m <= n; i++)
+        if (EL(y, i) == EL(x, 0) && m - 1 == __cdeMemMismatch(y + (i + 1) * nElem, x + nElem, m - 1, fWide))
+            return i;
+
+    return (size_t)-1;
+}
+#endif//MEMMEM_SSE2
+
+/** __cdeMemMem() - find the first occurrence of the needle in the haystack
+
+    n and m are element counts, fWide selects 16 bit elements
+
+    @retval pointer to the first occurrence, the haystack for an empty needle,
+            NULL if not found
+**/
+void* __cdeMemMem(const void* pHay, size_t n, const void* pNeedle, size_t m, int fWide) {
+    const unsigned char* y = pHay;
+    const unsigned char* x = pNeedle;
+    size_t nElem = fWide ? 2 : 1;
+    size_t pos;
+
+    if (0 == m)
+        return (void*)y;
+
+    if (m > n)
+        return NULL;
+
+    if (1 == m)
+        return fWide ? __cdeWMemChr((const unsigned short*)y, (unsigned short)EL(x, 0), n) : __cdeMemChr(y, EL(x, 0), n);
+
+#ifdef MEMMEM_SSE2
+    if (m <= PREFILTERMAX)
+        pos = __prefilter(y, n, x, m, fWide);
+    else
+#endif//MEMMEM_SSE2
+        pos = __twoWay(y, n, x, m, fWide);
+
+    return (size_t)-1 == pos ? NULL : (void*)(y + pos * nElem);
+}
@@ -0,0 +1,443 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    __cdeStrKernel.c
+
+Abstract:
+
+    CDE internal string scan kernels for strlen(), wcslen(), memchr(), wmemchr(),
+    strchr(), wcschr(), strrchr(), wcsrchr() and the internal _strlen()/_wcslen()
+    and mismatch kernels for the mem/str/wcs-compare functions in _cdeMemStrxCmp()
+
+    x64: SSE2 pcmpeqb/pcmpeqw and pmovmskb over 16 byte blocks
+    32Bit (PEI) and CDE_MEMKERNEL_PORTABLE: size_t words, SWAR has-zero test
+
+    Loads are aligned to the block or word size, so that a scan never touches
+    a page behind the page of the terminating character. The mismatch kernels
+    load both strings unaligned, and only if the block doesn't cross a page.
+    Wide strings at odd addresses are scanned character by character.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stddef.h>
+#if defined(_M_X64) && !defined(CDE_MEMKERNEL_PORTABLE)
+#   define STRKERNEL_SSE2
+#   include <intrin.h>
+#   include <emmintrin.h>
+#endif//defined(_M_X64) && !defined(CDE_MEMKERNEL_PORTABLE)
+
+#define PBYTE unsigned char*
+#define PWORD unsigned short*
+#define PAGEOK(p,n) (((size_t)(p) & 4095) <= 4096 - (n))                  /* n bytes at p within one page */
+
+#ifdef STRKERNEL_SSE2
+
+#define LDA(p) _mm_load_si128((const __m128i*)(p))
+#define MSK8(v,c) ((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, c)))
+#define MSK16(v,c) ((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi16(v, c)))
+
+static unsigned __bsf(unsigned m) {
+    unsigned long i;
+
+    _BitScanForward(&i, m);
+    return (unsigned)i;
+}
+
+static unsigned __bsr(unsigned m) {
+    unsigned long i;
+
+    _BitScanReverse(&i, m);
+    return (unsigned)i;
+}
+
+/** __strScan() - find the first character c or '\0', fZero: '\0' only
+
+    @retval pointer to the character found
+**/
+static const unsigned char* __strScan(const unsigned char* s, int c, int fWide, int fZero) {
+    const unsigned char* p = (const unsigned char*)((size_t)s & ~(size_t)15);
+    __m128i z = _mm_setzero_si128();
+    __m128i cc = fWide ? _mm_set1_epi16((short)c) : _mm_set1_epi8((char)c);
+    __m128i v = LDA(p);
+    unsigned m;
+
+    if (fWide)
+        m = (MSK16(v, z) | (fZero ? 0 : MSK16(v, cc))) >> (s - p) << (s - p);
+    else
+        m = (MSK8(v, z) | (fZero ? 0 : MSK8(v, cc))) >> (s - p) << (s - p);
+
+    while (0 == m) {
+        p += 16;
+        v = LDA(p);
+        m = fWide ? MSK16(v, z) | (fZero ? 0 : MSK16(v, cc)) : MSK8(v, z) | (fZero ? 0 : MSK8(v, cc));
+    }
+
+    return p + __bsf(m);
+}
+
+/** __memScan() - find c within n bytes
+
+    @retval pointer to c, NULL if not found
+**/
+static const unsigned char* __memScan(const unsigned char* s, int c, size_t n, int fWide) {
+    const unsigned char* p = (const unsigned char*)((size_t)s & ~(size_t)15);
+    __m128i cc = fWide ? _mm_set1_epi16((short)c) : _mm_set1_epi8((char)c);
+    size_t nAvail = 16 - (s - p);                                   // bytes of the first block at and behind s
+    unsigned m;
+
+    if (0 == n)
+        return NULL;
+
+    m = (fWide ? MSK16(LDA(p), cc) : MSK8(LDA(p), cc)) >> (s - p);
+
+    for (;;) {
+
+        if (0 != m)
+            return __bsf(m) < n ? (const unsigned char*)s + __bsf(m) : NULL;
+
+        if (n <= nAvail)
+            return NULL;
+
+        n -= nAvail;
+        s += nAvail;
+        p += 16;
+        nAvail = 16;
+
+        m = fWide ? MSK16(LDA(p), cc) : MSK8(LDA(p), cc);
+    }
+}
+
+/** __strScanLast() - find the last character c before '\0', c != '\0'
+
+    @retval pointer to c, NULL if not found
+**/
+static const unsigned char* __strScanLast(const unsigned char* s, int c, int fWide) {
+    const unsigned char* p = (const unsigned char*)((size_t)s & ~(size_t)15);
+    const unsigned char* pLast = NULL;
+    __m128i z = _mm_setzero_si128();
+    __m128i cc = fWide ? _mm_set1_epi16((short)c) : _mm_set1_epi8((char)c);
+    __m128i v = LDA(p);
+    unsigned mz, mc, mLast = 0;
+
+    mz = (fWide ? MSK16(v, z) : MSK8(v, z)) >> (s - p) << (s - p);
+    mc = (fWide ? MSK16(v, cc) : MSK8(v, cc)) >> (s - p) << (s - p);
+
+    for (;;) {
+
+        if (0 != mz)
+            mc &= mz ^ (mz - 1);                                    // matches up to the first '\0'
+
+        if (0 != mc) {
+            pLast = p;
+            mLast = mc;
+        }
+
+        if (0 != mz)
+            break;
+
+        p += 16;
+        v = LDA(p);
+        mz = fWide ? MSK16(v, z) : MSK8(v, z);
+        mc = fWide ? MSK16(v, cc) : MSK8(v, cc);
+    }
+
+    return NULL == pLast ? NULL : pLast + (fWide ? __bsr(mLast) & ~1 : __bsr(mLast));
+}
+
+/** __mismatch() - find the first element that differs, or is '\0' in s1 if fZero
+
+    n is the max. number of elements
+
+    @retval index of the element found, n if not found
+**/
+static size_t __mismatch(const unsigned char* s1, const unsigned char* s2, size_t n, int fWide, int fZero) {
+    size_t nElem = fWide ? 2 : 1;
+    size_t i = 0;
+    __m128i z = _mm_setzero_si128();
+    __m128i v1, v2;
+    unsigned m;
+
+    while (i < n) {
+
+        if (n - i >= 16 / nElem && (!fZero || (PAGEOK(s1, 16) && PAGEOK(s2, 16)))) {
+
+            v1 = _mm_loadu_si128((const __m128i*)s1);
+            v2 = _mm_loadu_si128((const __m128i*)s2);
+
+            if (fWide)
+                m = (0xFFFF & ~MSK16(v1, v2)) | (fZero ? MSK16(v1, z) : 0);
+            else
+                m = (0xFFFF & ~MSK8(v1, v2)) | (fZero ? MSK8(v1, z) : 0);
+
+            if (0 != m)
+                return i + __bsf(m) / nElem;
+
+            s1 += 16;
+            s2 += 16;
+            i += 16 / nElem;
+            continue;
+        }
+
+        if (fWide ? *(const PWORD)s1 != *(const PWORD)s2 || (fZero && 0 == *(const PWORD)s1) : *s1 != *s2 || (fZero && 0 == *s1))
+            return i;
+
+        s1 += nElem;
+        s2 += nElem;
+        i++;
+    }
+
+    return n;
+}
+
+#else //STRKERNEL_SSE2
+
+#define ONES ((size_t)0x0101010101010101ULL)
+#define ONES16 ((size_t)0x0001000100010001ULL)
+#define HASZERO(v) (((v) - ONES) & ~(v) & (ONES << 7))
+#define HASZERO16(v) (((v) - ONES16) & ~(v) & (ONES16 << 15))
+#define LDW(p) (*(const size_t*)(p))
+
+/** __strScan() - find the first character c or '\0', fZero: '\0' only
+
+    @retval pointer to the character found
+**/
+static const unsigned char* __strScan(const unsigned char* s, int c, int fWide, int fZero) {
+    size_t cc = fWide ? ONES16 * (unsigned short)c : ONES * (unsigned char)c;
+    size_t v;
+
+    for (;;) {
+
+        if (0 == ((size_t)s & (sizeof(size_t) - 1))) {
+
+            v = LDW(s);
+            if (0 == (fWide ? HASZERO16(v) | (fZero ? 0 : HASZERO16(v ^ cc)) : HASZERO(v) | (fZero ? 0 : HASZERO(v ^ cc)))) {
+                s += sizeof(size_t);
+                continue;
+            }
+        }
+
+        if (fWide) {
+            if (0 == *(const PWORD)s || (!fZero && (unsigned short)c == *(const PWORD)s))
+                return s;
+            s += 2;
+        }
+        else {
+            if (0 == *s || (!fZero && (unsigned char)c == *s))
+                return s;
+            s++;
+        }
+    }
+}
+
+/** __memScan() - find c within n bytes
+
+    @retval pointer to c, NULL if not found
+**/
+static const unsigned char* __memScan(const unsigned char* s, int c, size_t n, int fWide) {
+    size_t cc = fWide ? ONES16 * (unsigned short)c : ONES * (unsigned char)c;
+    size_t v;
+
+    while (0 != n) {
+
+        if (0 == ((size_t)s & (sizeof(size_t) - 1)) && n >= sizeof(size_t)) {
+
+            v = LDW(s) ^ cc;
+            if (0 == (fWide ? HASZERO16(v) : HASZERO(v))) {
+                s += sizeof(size_t);
+                n -= sizeof(size_t);
+                continue;
+            }
+        }
+
+        if (fWide) {
+            if ((unsigned short)c == *(const PWORD)s)
+                return s;
+            s += 2;
+            n -= 2;
+        }
+        else {
+            if ((unsigned char)c == *s)
+                return s;
+            s++;
+            n--;
+        }
+    }
+
+    return NULL;
+}
+
+/** __strScanLast() - find the last character c before '\0', c != '\0'
+
+    @retval pointer to c, NULL if not found
+**/
+static const unsigned char* __strScanLast(const unsigned char* s, int c, int fWide) {
+    const unsigned char* pLast = NULL;
+
+    for (;;) {
+
+        s = __strScan(s, c, fWide, 0);
+
+        if (fWide ? 0 == *(const PWORD)s : 0 == *s)
+            return pLast;
+
+        pLast = s;
+        s += fWide ? 2 : 1;
+    }
+}
+
+/** __mismatch() - find the first element that differs, or is '\0' in s1 if fZero
+
+    n is the max. number of elements
+
+    @retval index of the element found, n if not found
+**/
+static size_t __mismatch(const unsigned char* s1, const unsigned char* s2, size_t n, int fWide, int fZero) {
+    size_t nElem = fWide ? 2 : 1;
+    size_t i = 0;
+    size_t v1, v2;
+
+    while (i < n) {
+
+        if (n - i >= sizeof(size_t) / nElem && (!fZero || (PAGEOK(s1, sizeof(size_t)) && PAGEOK(s2, sizeof(size_t))))) {
+
+            v1 = LDW(s1);
+            v2 = LDW(s2);
+
+            if (0 == ((v1 ^ v2) | (fZero ? (fWide ? HASZERO16(v1) : HASZERO(v1)) : 0))) {
+                s1 += sizeof(size_t);
+                s2 += sizeof(size_t);
+                i += sizeof(size_t) / nElem;
+                continue;
+            }
+        }
+
+        if (fWide ? *(const PWORD)s1 != *(const PWORD)s2 || (fZero && 0 == *(const PWORD)s1) : *s1 != *s2 || (fZero && 0 == *s1))
+            return i;
+
+        s1 += nElem;
+        s2 += nElem;
+        i++;
+    }
+
+    return n;
+}
+
+#endif//STRKERNEL_SSE2
+
+/** __wcsOdd() - scan a wide string at an odd address, character by character
+
+    n is the max. number of characters, (size_t)-1 for a '\0' terminated string.
+    If fLast is set, the last c is found.
+
+    @retval pointer to c, or to '\0' if c is '\0', NULL if not found
+**/
+static const unsigned char* __wcsOdd(const unsigned char* s, unsigned short c, size_t n, int fLast) {
+    const unsigned char* pLast = NULL;
+    int fStr = (size_t)-1 == n;
+    unsigned short w;
+
+    for (/* s */; 0 != n; s += 2, n--) {
+
+        w = (unsigned short)(s[0] | (s[1] << 8));
+
+        if (c == w) {
+            if (0 == fLast || 0 == c)
+                return s;
+            pLast = s;
+        }
+
+        if (0 == w && fStr)
+            break;
+    }
+
+    return pLast;
+}
+
+/** __cdeStrLen() - strlen() kernel
+**/
+size_t __cdeStrLen(const char* pszStr) {
+    return (size_t)(__strScan((const PBYTE)pszStr, 0, 0, 1) - (const PBYTE)pszStr);
+}
+
+/** __cdeWcsLen() - wcslen() kernel
+**/
+size_t __cdeWcsLen(const unsigned short* pwcsStr) {
+    const unsigned char* p = 0 != ((size_t)pwcsStr & 1) ? __wcsOdd((const PBYTE)pwcsStr, 0, (size_t)-1, 0) : __strScan((const PBYTE)pwcsStr, 0, 1, 1);
+
+    return (size_t)(p - (const PBYTE)pwcsStr) / 2;
+}
+
+/** __cdeMemChr() - memchr() kernel, n bytes
+**/
+void* __cdeMemChr(const void* s, int c, size_t n) {
+    return (void*)__memScan((const PBYTE)s, c, n, 0);
+}
+
+/** __cdeWMemChr() - wmemchr() kernel, n wide characters
+**/
+void* __cdeWMemChr(const unsigned short* s, unsigned short c, size_t n) {
+
+    if (0 != ((size_t)s & 1))
+        return (void*)__wcsOdd((const PBYTE)s, c, n, 0);
+
+    return (void*)__memScan((const PBYTE)s, c, n > (size_t)-1 / 2 ? (size_t)-1 : n * 2, 1);   // saturate, wcsnlen(s, (size_t)-1)
+}
+
+/** __cdeStrChr() - strchr()/wcschr() kernel
+
+    The terminating '\0' is part of the string.
+**/
+void* __cdeStrChr(const void* pszStr, int c, int fWide) {
+    const unsigned char* p;
+
+    if (fWide && 0 != ((size_t)pszStr & 1))
+        return (void*)__wcsOdd((const PBYTE)pszStr, (unsigned short)c, (size_t)-1, 0);
+
+    p = __strScan((const PBYTE)pszStr, c, fWide, 0);
+
+    if (fWide)
+        return (unsigned short)c == *(const PWORD)p ? (void*)p : NULL;
+
+    return (unsigned char)c == *p ? (void*)p : NULL;
+}
+
+/** __cdeStrRChr() - strrchr()/wcsrchr() kernel
+
+    The terminating '\0' is part of the string.
+**/
+void* __cdeStrRChr(const void* pszStr, int c, int fWide) {
+
+    if (fWide && 0 != ((size_t)pszStr & 1))
+        return (void*)__wcsOdd((const PBYTE)pszStr, (unsigned short)c, (size_t)-1, 1);
+
+    if (fWide ? 0 == (unsigned short)c : 0 == (unsigned char)c)
+        return (void*)__strScan((const PBYTE)pszStr, 0, fWide, 1);
+
+    return (void*)__strScanLast((const PBYTE)pszStr, c, fWide);
+}
+
+/** __cdeMemMismatch() - memcmp()/wmemcmp() kernel, n elements
+
+    @retval index of the first element that differs, n if equal
+**/
+size_t __cdeMemMismatch(const void* s1, const void* s2, size_t n, int fWide) {
+    return __mismatch((const PBYTE)s1, (const PBYTE)s2, n, fWide, 0);
+}
+
+/** __cdeStrMismatch() - strcmp()/wcscmp() kernel, max. n elements
+
+    @retval index of the first element that differs or is '\0', n if not found
+**/
+size_t __cdeStrMismatch(const void* s1, const void* s2, size_t n, int fWide) {
+    return __mismatch((const PBYTE)s1, (const PBYTE)s2, n, fWide, 1);
+}
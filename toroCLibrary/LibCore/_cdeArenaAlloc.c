@@ -0,0 +1,115 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    _cdeArenaAlloc.c
+
+Abstract:
+
+    Toro C Library arena (bump) allocator, allocate memory from an arena
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+
+#define PAGESIZE 4096
+#define ARENAHDX ((sizeof(HEAPDESC) + CDE_HEAP_ALIGN - 1) & ~(CDE_HEAP_ALIGN - 1))
+
+/** _cdeArenaAlloc()
+
+Synopsis
+
+    void* _cdeArenaAlloc(
+        CDE_APP_IF* pCdeAppIf,
+        CDEARENA* pArena,
+        size_t size
+    )
+
+Description
+
+    Allocate size bytes from an arena, aligned to CDE_HEAP_ALIGN.
+    Memory is taken from the current chunk by pointer increment.
+    If the current chunk is exhausted, the next chunk retained by _cdeArenaReset()
+    is used, otherwise a new chunk is allocated from the OSIF.
+    There is no function to free a single allocation.
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[in] CDEARENA* pArena
+    @param[in] size_t size
+
+    @retval void * memory block
+            NULL on FAIL
+
+**/
+void* _cdeArenaAlloc(
+    CDE_APP_IF* pCdeAppIf,
+    IN CDEARENA* pArena,
+    IN size_t size
+)
+{
+    void* pRet = NULL;
+    HEAPDESC* pChunk;
+    unsigned long long qwPages;
+
+    do {
+
+        if (NULL == pArena || ARENAMEM != pArena->qwMagic)
+            break;
+
+        if (size > ~(size_t)0 - 4 * PAGESIZE)                       // prevent overflow of size calculations
+            break;
+
+        size = size == 0 ? CDE_HEAP_ALIGN : (size + CDE_HEAP_ALIGN - 1) & ~((size_t)CDE_HEAP_ALIGN - 1);
+
+        while ((size_t)(pArena->pLimit - pArena->pBump) < size) {
+
+            pChunk = pArena->pChunk->pSucc;                         // chunk retained by _cdeArenaReset()
+
+            if (NULL == pChunk || (size_t)pChunk->Pages * PAGESIZE - ARENAHDX < size) {
+
+                qwPages = ((unsigned long long)size + ARENAHDX + PAGESIZE - 1) / PAGESIZE;
+                if (qwPages < pArena->nChunkPages)
+                    qwPages = pArena->nChunkPages;
+                if (qwPages >= CDE_MEMALLOC_PAGES_MAX)
+                    break;
+
+                pChunk = pCdeAppIf->pCdeServices->pMemAlloc(pCdeAppIf, (unsigned int)qwPages);
+                if (NULL == pChunk)
+                    break;
+
+                pChunk->qwMagic = ARENAMEM;                         // NOTE: fInalterable is set by pMemAlloc()
+                pChunk->PageBase = (unsigned long long)pChunk;
+                pChunk->Pages = (unsigned long)qwPages;
+                pChunk->pPred = pArena->pChunk;
+                pChunk->pSucc = pArena->pChunk->pSucc;              // keep retained chunks behind the new one
+                if (NULL != pChunk->pSucc)
+                    pChunk->pSucc->pPred = pChunk;
+                pArena->pChunk->pSucc = pChunk;
+            }
+
+            pArena->pChunk = pChunk;
+            pArena->pBump = (unsigned char*)pChunk + ARENAHDX;
+            pArena->pLimit = (unsigned char*)pChunk + (size_t)pChunk->Pages * PAGESIZE;
+        }
+
+        if ((size_t)(pArena->pLimit - pArena->pBump) < size)
+            break;
+
+        pRet = pArena->pBump;
+        pArena->pBump += size;
+
+    } while (0);
+
+    return pRet;
+}
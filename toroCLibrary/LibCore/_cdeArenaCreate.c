@@ -0,0 +1,99 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    _cdeArenaCreate.c
+
+Abstract:
+
+    Toro C Library arena (bump) allocator, create an arena
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+
+#define PAGESIZE 4096
+#define ARENAHDX ((sizeof(HEAPDESC) + CDE_HEAP_ALIGN - 1) & ~(CDE_HEAP_ALIGN - 1))
+#define ARENASIZ ((sizeof(CDEARENA) + CDE_HEAP_ALIGN - 1) & ~(CDE_HEAP_ALIGN - 1))
+
+/** _cdeArenaCreate()
+
+Synopsis
+
+    CDEARENA* _cdeArenaCreate(
+        CDE_APP_IF* pCdeAppIf,
+        size_t nChunkSize
+    )
+
+Description
+
+    Create an arena. The first page chunk is allocated from the OSIF and holds
+    the CDEARENA control structure. Further chunks are nChunkSize bytes,
+    rounded up to pages, or larger if required by _cdeArenaAlloc().
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[in] size_t nChunkSize : default chunk size, 0 for one page
+
+    @retval CDEARENA* arena
+            NULL on FAIL, or if the CDE_SERVICES do not provide HEAPCTRL
+
+**/
+CDEARENA* _cdeArenaCreate(
+    CDE_APP_IF* pCdeAppIf,
+    IN size_t nChunkSize
+)
+{
+    unsigned long long qwPages = ((unsigned long long)nChunkSize + PAGESIZE - 1) / PAGESIZE;
+    HEAPDESC* pChunk = NULL;
+    CDEARENA* pArena = NULL;
+
+    do {
+
+        if (!CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices))
+            break;                                                  // CDE_SERVICES without HEAPCTRL
+
+        if (qwPages < 1)
+            qwPages = 1;
+
+        if (qwPages >= CDE_MEMALLOC_PAGES_MAX)
+            break;
+
+        pChunk = pCdeAppIf->pCdeServices->pMemAlloc(pCdeAppIf, (unsigned int)qwPages);
+        if (NULL == pChunk)
+            break;
+
+        pChunk->qwMagic = ARENAMEM;                                 // NOTE: fInalterable is set by pMemAlloc()
+        pChunk->PageBase = (unsigned long long)pChunk;
+        pChunk->Pages = (unsigned long)qwPages;
+        pChunk->pPred = NULL;
+        pChunk->pSucc = NULL;
+
+        pArena = (CDEARENA*)((unsigned char*)pChunk + ARENAHDX);
+        pArena->qwMagic = ARENAMEM;
+        pArena->pFirst = pChunk;
+        pArena->pChunk = pChunk;
+        pArena->pBump = (unsigned char*)pArena + ARENASIZ;
+        pArena->pLimit = (unsigned char*)pChunk + qwPages * PAGESIZE;
+        pArena->nChunkPages = (unsigned long)qwPages;
+
+        pArena->pPred = NULL;
+        pArena->pSucc = pCdeAppIf->pCdeServices->HeapCtrl.pArena;
+        if (NULL != pArena->pSucc)
+            pArena->pSucc->pPred = pArena;
+        pCdeAppIf->pCdeServices->HeapCtrl.pArena = pArena;
+
+    } while (0);
+
+    return pArena;
+}
@@ -0,0 +1,69 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    _cdeArenaDestroy.c
+
+Abstract:
+
+    Toro C Library arena (bump) allocator, destroy an arena
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+
+/** _cdeArenaDestroy()
+
+Synopsis
+
+    void _cdeArenaDestroy(
+        CDE_APP_IF* pCdeAppIf,
+        CDEARENA* pArena
+    )
+
+Description
+
+    Return all page chunks of an arena, including the CDEARENA control structure itself.
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[in] CDEARENA* pArena
+
+    @retval void
+
+**/
+void _cdeArenaDestroy(
+    CDE_APP_IF* pCdeAppIf,
+    IN CDEARENA* pArena
+)
+{
+    HEAPDESC* pChunk, * pSucc;
+
+    if (NULL != pArena && ARENAMEM == pArena->qwMagic && CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices)) {
+
+        pArena->qwMagic = FREEMEM;
+
+        if (NULL != pArena->pSucc)
+            pArena->pSucc->pPred = pArena->pPred;
+        if (NULL != pArena->pPred)
+            pArena->pPred->pSucc = pArena->pSucc;
+        else
+            pCdeAppIf->pCdeServices->HeapCtrl.pArena = pArena->pSucc;
+
+        for (pChunk = pArena->pFirst; NULL != pChunk; pChunk = pSucc) {
+            pSucc = pChunk->pSucc;
+            pChunk->qwMagic = FREEMEM;
+            pCdeAppIf->pCdeServices->pMemFree(pCdeAppIf, pChunk->PageBase, (unsigned int)pChunk->Pages);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    _cdeArenaReset.c
+
+Abstract:
+
+    Toro C Library arena (bump) allocator, release all allocations of an arena
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+
+#define PAGESIZE 4096
+#define ARENASIZ ((sizeof(CDEARENA) + CDE_HEAP_ALIGN - 1) & ~(CDE_HEAP_ALIGN - 1))
+
+/** _cdeArenaReset()
+
+Synopsis
+
+    void _cdeArenaReset(
+        CDE_APP_IF* pCdeAppIf,
+        CDEARENA* pArena
+    )
+
+Description
+
+    Release all allocations of an arena at once.
+    The page chunks are retained and reused by subsequent _cdeArenaAlloc().
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[in] CDEARENA* pArena
+
+    @retval void
+
+**/
+void _cdeArenaReset(
+    CDE_APP_IF* pCdeAppIf,
+    IN CDEARENA* pArena
+)
+{
+    if (NULL != pArena && ARENAMEM == pArena->qwMagic) {
+        pArena->pChunk = pArena->pFirst;
+        pArena->pBump = (unsigned char*)pArena + ARENASIZ;
+        pArena->pLimit = (unsigned char*)pArena->pFirst + (size_t)pArena->pFirst->Pages * PAGESIZE;
+    }
+}
@@ -0,0 +1,366 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    _cdeHeapProf.c
+
+Abstract:
+
+    Toro C Library allocation site heap profiler
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+
+#define PAGESIZE 4096
+
+typedef unsigned long long EFI_PHYSICAL_ADDRESS;
+
+extern int _cdeCoreSprintf(CDE_APP_IF* pCdeAppIf, char* pszDest, const char* pszFormat, ...);
+
+HEAPPROFSTART   _cdeHeapProfStart;//prototype
+HEAPPROFSTOP    _cdeHeapProfStop;//prototype
+HEAPPROFDUMP    _cdeHeapProfDump;//prototype
+
+//
+// pointer hash for the site and live block tables
+//
+static unsigned __profHash(void* p, unsigned nMask) {
+    unsigned long long x = (unsigned long long)(size_t)p;
+
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+
+    return (unsigned)x & nMask;
+}
+
+static CDEHEAPSITE* __profSite(CDEHEAPPROF* pProf, void* pSite) {
+    unsigned i, idx = __profHash(pSite, CDE_HEAPPROF_SITES - 1);
+
+    for (i = 0; i < CDE_HEAPPROF_SITES; i++, idx = (idx + 1) & (CDE_HEAPPROF_SITES - 1)) {
+
+        if (pProf->rgSite[idx].pSite == pSite)
+            return &pProf->rgSite[idx];
+
+        if (NULL == pProf->rgSite[idx].pSite) {
+            pProf->rgSite[idx].pSite = pSite;
+            return &pProf->rgSite[idx];
+        }
+    }
+
+    return NULL;                                                    // site table full
+}
+
+static int __profLiveAdd(CDEHEAPPROF* pProf, void* ptr, size_t size, CDEHEAPSITE* pSite) {
+    unsigned i, idx = __profHash(ptr, CDE_HEAPPROF_LIVE - 1);
+
+    for (i = 0; i < CDE_HEAPPROF_LIVE; i++, idx = (idx + 1) & (CDE_HEAPPROF_LIVE - 1)) {
+
+        if (NULL == pProf->rgLive[idx].ptr) {
+            pProf->rgLive[idx].ptr = ptr;
+            pProf->rgLive[idx].size = size;
+            pProf->rgLive[idx].pSite = pSite;
+            pSite->qwLiveBytes += size;
+            return 1;
+        }
+    }
+
+    return 0;                                                       // live block table full
+}
+
+/** __profLiveRemove() - remove a live block, with backward shift of the successing entries
+**/
+static void __profLiveRemove(CDEHEAPPROF* pProf, void* ptr) {
+    const unsigned nMask = CDE_HEAPPROF_LIVE - 1;
+    unsigned i, j, k, idx = __profHash(ptr, nMask);
+
+    for (i = 0; i < CDE_HEAPPROF_LIVE; i++, idx = (idx + 1) & nMask) {
+
+        if (NULL == pProf->rgLive[idx].ptr)
+            return;                                                 // allocated before _cdeHeapProfStart()
+
+        if (pProf->rgLive[idx].ptr == ptr)
+            break;
+    }
+
+    if (i == CDE_HEAPPROF_LIVE)
+        return;
+
+    pProf->rgLive[idx].pSite->qwLiveBytes -= pProf->rgLive[idx].size;
+
+    for (i = idx, j = (idx + 1) & nMask; NULL != pProf->rgLive[j].ptr; j = (j + 1) & nMask) {
+
+        k = __profHash(pProf->rgLive[j].ptr, nMask);                // home slot of entry j
+
+        if (((j - k) & nMask) >= ((j - i) & nMask)) {               // home slot not between i and j
+            pProf->rgLive[i] = pProf->rgLive[j];
+            i = j;
+        }
+    }
+
+    pProf->rgLive[i].ptr = NULL;
+}
+
+/** _cdeHeapProfRecord() - record a call of the suballocator
+
+    Called by the suballocator, if the heap profiler is started.
+**/
+void _cdeHeapProfRecord(CDE_APP_IF* pCdeAppIf, CDEHEAPPROFREC* pRec) {
+    CDEHEAPPROF* pProf = pCdeAppIf->pCdeServices->HeapCtrl.pProf;
+    CDEHEAPSITE* pSite;
+
+    if (NULL == pProf)
+        return;                                                     // heap restarted, Post-Memory-PEI
+
+    pProf->pRing[pProf->qwRecords++ % pProf->nRing] = *pRec;
+
+    if (NULL != pRec->ptr && (NULL != pRec->pRet || 0 == pRec->size))
+        __profLiveRemove(pProf, pRec->ptr);                         // released or moved
+
+    if (NULL == (pSite = __profSite(pProf, pRec->pSite))) {
+        pProf->qwLost++;
+        return;
+    }
+
+    pSite->qwCount++;
+    pSite->qwBytes += pRec->size;
+    pSite->qwTicks += pRec->qwTicks;
+
+    if (NULL != pRec->pRet)
+        if (0 == __profLiveAdd(pProf, pRec->pRet, pRec->size, pSite))
+            pProf->qwLost++;
+}
+
+/** _cdeHeapProfStart()
+
+Synopsis
+
+    int _cdeHeapProfStart(
+        CDE_APP_IF* pCdeAppIf,
+        unsigned nRing
+    )
+
+Description
+
+    Start the allocation site heap profiler.
+
+    The profiler memory, CDEHEAPPROF and a ring of nRing CDEHEAPPROFREC, is taken
+    from pMemAlloc(), not from the suballocator itself. A running profiler is stopped
+    and restarted with empty tables.
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[in] unsigned nRing : number of ring records, at least 1
+
+    @retval 0 on success
+            -1 on FAIL
+
+**/
+int _cdeHeapProfStart(
+    CDE_APP_IF* pCdeAppIf,
+    IN unsigned nRing
+)
+{
+    HEAPCTRL* pCtrl = &pCdeAppIf->pCdeServices->HeapCtrl;
+    CDEHEAPPROF* pProf;
+    unsigned long long qwSize, qwPages;
+    unsigned char* pb;
+    size_t i;
+    int nRet = -1;
+
+    do {
+
+        if (!CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices))
+            break;                                                  // CDE_SERVICES without HEAPCTRL
+
+        _cdeHeapProfStop(pCdeAppIf);
+
+        if (0 == nRing)
+            break;
+
+        qwSize = sizeof(CDEHEAPPROF) + (unsigned long long)nRing * sizeof(CDEHEAPPROFREC);
+        qwPages = (qwSize + PAGESIZE - 1) / PAGESIZE;
+
+        if (qwPages > CDE_MEMALLOC_PAGES_MAX)
+            break;
+
+        pProf = (CDEHEAPPROF*)pCdeAppIf->pCdeServices->pMemAlloc(pCdeAppIf, (unsigned long)qwPages);
+        if (NULL == pProf)
+            break;
+
+        for (pb = (unsigned char*)pProf, i = 0; i < sizeof(CDEHEAPPROF); i++)
+            pb[i] = 0;
+
+        pProf->Pages = (unsigned long)qwPages;
+        pProf->nRing = nRing;
+        pProf->pRing = (CDEHEAPPROFREC*)&pProf[1];
+
+        pCtrl->pProf = pProf;
+        nRet = 0;
+
+    } while (0);
+
+    return nRet;
+}
+
+/** _cdeHeapProfStop()
+
+Synopsis
+
+    void _cdeHeapProfStop(
+        CDE_APP_IF* pCdeAppIf
+    )
+
+Description
+
+    Stop the allocation site heap profiler and return the profiler memory.
+    Invoked on exit by _cdeMemRelease().
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+
+    @retval void
+
+**/
+void _cdeHeapProfStop(
+    CDE_APP_IF* pCdeAppIf
+)
+{
+    HEAPCTRL* pCtrl = &pCdeAppIf->pCdeServices->HeapCtrl;
+    CDEHEAPPROF* pProf = CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices) ? pCtrl->pProf : NULL;
+
+    if (NULL != pProf) {
+        pCtrl->pProf = NULL;
+        pCdeAppIf->pCdeServices->pMemFree(pCdeAppIf, (EFI_PHYSICAL_ADDRESS)pProf, pProf->Pages);
+    }
+}
+
+/** _cdeHeapProfDump()
+
+Synopsis
+
+    int _cdeHeapProfDump(
+        CDE_APP_IF* pCdeAppIf,
+        unsigned (*pfnWriteStr)(char* szLine),
+        int fRing
+    )
+
+Description
+
+    Write the histogram of the allocation sites, ordered by the time spent in the
+    suballocator, one text line per site:
+
+        site count bytes livebytes ticks
+
+    If fRing is set, the ring records follow, oldest first:
+
+        tsc site ptr size ret ticks
+
+    pfnWriteStr is the line output routine, as for _cdeXDump(), that writes to
+    a file or to the debug trace.
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[in] unsigned (*pfnWriteStr)(char* szLine)
+    @param[in] int fRing
+
+    @retval number of lines written
+            -1 if the heap profiler is not started
+
+**/
+int _cdeHeapProfDump(
+    CDE_APP_IF* pCdeAppIf,
+    IN unsigned (*pfnWriteStr)(char* szLine),
+    IN int fRing
+)
+{
+    CDEHEAPPROF* pProf = CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices) ? pCdeAppIf->pCdeServices->HeapCtrl.pProf : NULL;
+    CDEHEAPSITE* pSite, * pLast = NULL;
+    CDEHEAPPROFREC* pRec;
+    unsigned long long qw, qwFirst;
+    unsigned i;
+    char szLine[160];
+    int nRet = -1;
+
+    do {
+
+        if (NULL == pProf)
+            break;
+
+        _cdeCoreSprintf(pCdeAppIf, szLine, "# sites, records %llu, lost %llu\n# site count bytes livebytes ticks\n", pProf->qwRecords, pProf->qwLost);
+        (*pfnWriteStr)(szLine);
+        nRet = 2;
+
+        //
+        // descending order of (qwTicks, table position), without sorting the site table
+        //
+        for (;;) {
+
+            pSite = NULL;
+
+            for (i = 0; i < CDE_HEAPPROF_SITES; i++) {
+
+                CDEHEAPSITE* p = &pProf->rgSite[i];
+
+                if (NULL == p->pSite)
+                    continue;
+
+                if (NULL != pLast && (p->qwTicks > pLast->qwTicks || (p->qwTicks == pLast->qwTicks && p >= pLast)))
+                    continue;                                       // already written
+
+                if (NULL == pSite || p->qwTicks > pSite->qwTicks || (p->qwTicks == pSite->qwTicks && p > pSite))
+                    pSite = p;
+            }
+
+            if (NULL == pSite)
+                break;
+
+            _cdeCoreSprintf(pCdeAppIf, szLine, "%016llX %llu %llu %llu %llu\n",
+                (unsigned long long)(size_t)pSite->pSite, pSite->qwCount, pSite->qwBytes, pSite->qwLiveBytes, pSite->qwTicks);
+            (*pfnWriteStr)(szLine);
+            nRet++;
+
+            pLast = pSite;
+        }
+
+        if (0 == fRing)
+            break;
+
+        qwFirst = pProf->qwRecords > pProf->nRing ? pProf->qwRecords - pProf->nRing : 0ULL;
+
+        _cdeCoreSprintf(pCdeAppIf, szLine, "# ring, records %llu\n# tsc site ptr size ret ticks\n", pProf->qwRecords - qwFirst);
+        (*pfnWriteStr)(szLine);
+        nRet += 2;
+
+        for (qw = qwFirst; qw < pProf->qwRecords; qw++) {
+
+            pRec = &pProf->pRing[qw % pProf->nRing];
+
+            _cdeCoreSprintf(pCdeAppIf, szLine, "%016llX %016llX %016llX %llu %016llX %llu\n",
+                pRec->qwTsc,
+                (unsigned long long)(size_t)pRec->pSite,
+                (unsigned long long)(size_t)pRec->ptr,
+                (unsigned long long)pRec->size,
+                (unsigned long long)(size_t)pRec->pRet,
+                pRec->qwTicks);
+            (*pfnWriteStr)(szLine);
+            nRet++;
+        }
+
+    } while (0);
+
+    return nRet;
+}
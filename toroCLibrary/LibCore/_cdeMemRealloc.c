@@ -20,19 +20,825 @@ Author:
 
 --*/
 #include <CdeServices.h>
+#include <intrin.h>
 
 #define PBYTE unsigned char*
 #define PAGESIZE 4096
-
-void* _cdeMemRealloc(
+#define BINNEXT(p) (*(HEAPDESC**)&(p)->CrumbleFront)    /* size class list forward link  */
+#define BINPREV(p) (*(HEAPDESC**)&(p)->CrumbleRear)     /* size class list backward link */
+#define RUNNEXT(p) (*(HEAPDESC**)&(p)->CrumbleFront)    /* page run list forward link, ENDOFMEM */
+#define RUNPREV(p) (*(HEAPDESC**)&(p)->CrumbleRear)     /* page run list backward link, ENDOFMEM */
+#define BLKSIZE(p) ((size_t)((PBYTE)&(p)->pSucc[0] - (PBYTE)&(p)[1]))
+#define SLABHDX ((sizeof(SLABDESC) + CDE_HEAP_ALIGN - 1) & ~(CDE_HEAP_ALIGN - 1))   /* slot area offset */
+#define SLABMAX (CDE_SLAB_CLASSES * CDE_HEAP_ALIGN)                                 /* max. slab slot size */
+#define TINYHDX ((sizeof(TINYDESC) + CDE_TINY_ALIGN - 1) & ~(CDE_TINY_ALIGN - 1))    /* first compact heap block offset */
+#define TINYSIZE(h) ((h)->cbSize & ~(size_t)1)
+#define TINYNEXT(h) ((TINYHDR*)((PBYTE)(h) + TINYSIZE(h)))
+#define TINYPREV(h) ((TINYHDR*)((PBYTE)(h) - (h)->cbPrev))
+
+static void* __cdeMemRealloc(
     CDE_APP_IF* pCdeAppIf,
     IN void* ptr,   /* input pointer for realloc */
     IN size_t size, /*  input size for realloc*/
     HEAPDESC* pHeapStart
 );
 
+static void* __cdeMemAlignedRealloc(
+    CDE_APP_IF* pCdeAppIf,
+    IN void* ptr,
+    IN size_t size,
+    IN size_t alignment,
+    HEAPDESC* pHeapStart
+);
+
 typedef unsigned long long EFI_PHYSICAL_ADDRESS;
 
+extern void _cdeHeapProfRecord(CDE_APP_IF* pCdeAppIf, CDEHEAPPROFREC* pRec);
+
+extern unsigned long _gCdeCfgHeapPageCacheHigh;
+extern unsigned long _gCdeCfgHeapPageCacheLow;
+
+//
+// bit scan helpers, independent from compiler intrinsics. x != 0
+//
+static unsigned __heapMsb(unsigned long long x) {
+    unsigned n = 0;
+
+    if (x >> 32) n += 32, x >>= 32;
+    if (x >> 16) n += 16, x >>= 16;
+    if (x >> 8) n += 8, x >>= 8;
+    if (x >> 4) n += 4, x >>= 4;
+    if (x >> 2) n += 2, x >>= 2;
+    if (x >> 1) n += 1;
+
+    return n;
+}
+
+static unsigned __heapLsb(unsigned long long x) {
+    return __heapMsb(x & (~x + 1));
+}
+
+/** __heapBinIndex() - get size class of a block size
+
+    Sizes 0..3 map to class 0..3, each power of two above is split into four sub classes.
+    All blocks of a class with a higher index are greater than all blocks of the lower class.
+**/
+static unsigned __heapBinIndex(size_t size) {
+    unsigned fl;
+
+    if (size < 4)
+        return (unsigned)size;
+
+    fl = __heapMsb(size);
+
+    return 4 * fl + (unsigned)((size >> (fl - 2)) & 3);
+}
+
+/** __heapPoolOf() - get the fixed pool, that holds a HEAPDESC block
+
+    @retval HEAPPOOL* if p is within the page run of a fixed pool
+            NULL otherwise
+**/
+static HEAPPOOL* __heapPoolOf(HEAPCTRL* pCtrl, void* p) {
+    HEAPPOOL* pPool;
+
+    for (pPool = pCtrl->pPool; NULL != pPool; pPool = pPool->pSucc)
+        if ((PBYTE)p >= pPool->pBase && (PBYTE)p < pPool->pEnd)
+            break;
+
+    return pPool;
+}
+
+/** __heapPoolOwned() - get the fixed pool of the driver
+
+    @retval HEAPPOOL* if the driver reserved a fixed pool
+            NULL otherwise
+**/
+static HEAPPOOL* __heapPoolOwned(CDE_APP_IF* pCdeAppIf, HEAPCTRL* pCtrl) {
+    HEAPPOOL* pPool;
+
+    for (pPool = pCtrl->pPool; NULL != pPool; pPool = pPool->pSucc)
+        if (pPool->pOwner == (void*)pCdeAppIf)
+            break;
+
+    return pPool;
+}
+
+/** __heapBinInsert() - insert a FREEMEM block into its size class list
+
+    Blocks of a fixed pool are inserted into the size class lists of the pool.
+**/
+static void __heapBinInsert(HEAPCTRL* pCtrl, HEAPDESC* pFree) {
+    unsigned idx = __heapBinIndex(BLKSIZE(pFree));
+    HEAPPOOL* pPool = __heapPoolOf(pCtrl, pFree);
+    HEAPDESC** rgpBin = NULL == pPool ? pCtrl->rgpBin : pPool->rgpBin;
+    unsigned long long* bmBins = NULL == pPool ? pCtrl->bmBins : pPool->bmBins;
+
+    BINPREV(pFree) = NULL;
+    BINNEXT(pFree) = rgpBin[idx];
+    if (NULL != BINNEXT(pFree))
+        BINPREV(BINNEXT(pFree)) = pFree;
+    rgpBin[idx] = pFree;
+    bmBins[idx / 64] |= 1ULL << (idx % 64);
+}
+
+static void __heapBinRemove(HEAPCTRL* pCtrl, HEAPDESC* pFree) {
+    unsigned idx = __heapBinIndex(BLKSIZE(pFree));
+    HEAPPOOL* pPool = __heapPoolOf(pCtrl, pFree);
+    HEAPDESC** rgpBin = NULL == pPool ? pCtrl->rgpBin : pPool->rgpBin;
+    unsigned long long* bmBins = NULL == pPool ? pCtrl->bmBins : pPool->bmBins;
+
+    if (NULL != BINNEXT(pFree))
+        BINPREV(BINNEXT(pFree)) = BINPREV(pFree);
+
+    if (NULL != BINPREV(pFree))
+        BINNEXT(BINPREV(pFree)) = BINNEXT(pFree);
+    else
+        rgpBin[idx] = BINNEXT(pFree);
+
+    if (NULL == rgpBin[idx])
+        bmBins[idx / 64] &= ~(1ULL << (idx % 64));
+}
+
+/** __heapBinFind() - find a FREEMEM block that holds size bytes
+
+    pPool selects the size class lists of a fixed pool, NULL the shared ones.
+
+    1. the head of the own size class, if it fits
+    2. the first block of the next non-empty higher size class, that always fits
+    3. first fit scan of the own size class, skipped with a fixed pool for bounded time
+**/
+static HEAPDESC* __heapBinFind(HEAPCTRL* pCtrl, HEAPPOOL* pPool, size_t size) {
+    unsigned idx = __heapBinIndex(size);
+    unsigned i;
+    unsigned long long bm;
+    HEAPDESC** rgpBin = NULL == pPool ? pCtrl->rgpBin : pPool->rgpBin;
+    unsigned long long* bmBins = NULL == pPool ? pCtrl->bmBins : pPool->bmBins;
+    HEAPDESC* pFree = rgpBin[idx];
+
+    pCtrl->Count.qwBinFind++;
+
+    if (NULL != pFree && BLKSIZE(pFree) >= size)
+        return pFree;
+
+    for (i = idx + 1; i < CDE_HEAP_BINS; i = (i | 63) + 1) {
+        bm = bmBins[i / 64] & (~0ULL << (i % 64));
+        if (0 != bm)
+            return rgpBin[(i & ~63) + __heapLsb(bm)];
+    }
+
+    if (NULL != pPool)
+        return NULL;
+
+    for (/* pFree = rgpBin[idx] */; NULL != pFree; pFree = BINNEXT(pFree)) {
+        pCtrl->Count.qwBinScan++;
+        if (BLKSIZE(pFree) >= size)
+            break;
+    }
+
+    return pFree;
+}
+
+/** __pageFlush() - hand back cached page runs to the OSIF
+
+    The most recently released runs are kept, until not more than qwPagesKeep pages remain.
+**/
+static void __pageFlush(CDE_APP_IF* pCdeAppIf, HEAPCTRL* pCtrl, unsigned long long qwPagesKeep) {
+    HEAPDESC* pRun = pCtrl->pPageCache, * pSucc;
+    HEAPDESC** ppLink = &pCtrl->pPageCache;
+    unsigned long long qwPages = 0;
+
+    for (/* pRun */; NULL != pRun; pRun = pSucc) {
+
+        pSucc = pRun->pSucc;
+
+        if (qwPages + pRun->Pages <= qwPagesKeep) {
+            qwPages += pRun->Pages;
+            *ppLink = pRun;
+            ppLink = &pRun->pSucc;
+            continue;
+        }
+
+        pCtrl->qwPageCachePages -= pRun->Pages;
+        pCtrl->Count.qwPagesFree += pRun->Pages;
+        pCdeAppIf->pCdeServices->pMemFree(pCdeAppIf, pRun->PageBase, (unsigned int)pRun->Pages);
+    }
+    *ppLink = NULL;
+}
+
+/** __pageAlloc() - get a page run from the page cache or the OSIF
+
+    A cached run of *pqwPages up to qwPagesMax pages is preferred, best fit.
+    On return *pqwPages holds the size of the run. If the OSIF fails,
+    the page cache is handed back and the OSIF is retried.
+    *pfZero reports zeroed pages, fresh from the OSIF.
+**/
+static void* __pageAlloc(CDE_APP_IF* pCdeAppIf, HEAPCTRL* pCtrl, unsigned long long* pqwPages, unsigned long long qwPagesMax, int* pfZero) {
+    HEAPDESC* pRun, * pBest = NULL;
+    HEAPDESC** ppLink, ** ppBest = NULL;
+    void* pPageBase;
+
+    for (ppLink = &pCtrl->pPageCache; NULL != (pRun = *ppLink); ppLink = &pRun->pSucc) {
+        if (pRun->Pages >= *pqwPages && pRun->Pages <= qwPagesMax && (NULL == pBest || pRun->Pages < pBest->Pages)) {
+            pBest = pRun;
+            ppBest = ppLink;
+            if (pRun->Pages == *pqwPages)
+                break;
+        }
+    }
+
+    *pfZero = FALSE;
+
+    if (NULL != pBest) {
+        *ppBest = pBest->pSucc;
+        pCtrl->qwPageCachePages -= pBest->Pages;
+        *pqwPages = pBest->Pages;
+        return pBest;                                               // NOTE: fInalterable is FALSE
+    }
+
+    pPageBase = pCdeAppIf->pCdeServices->pMemAlloc(pCdeAppIf, (unsigned int)*pqwPages);
+
+    if (NULL == pPageBase && NULL != pCtrl->pPageCache) {           // memory pressure
+        __pageFlush(pCdeAppIf, pCtrl, 0);
+        pPageBase = pCdeAppIf->pCdeServices->pMemAlloc(pCdeAppIf, (unsigned int)*pqwPages);
+    }
+
+    *pfZero = NULL != pPageBase && FALSE != pCtrl->fZeroPages;
+
+    if (NULL != pPageBase)
+        pCtrl->Count.qwPagesAlloc += *pqwPages;
+
+    return pPageBase;
+}
+
+/** __pageFree() - retain a page run in the page cache
+
+    If the page cache exceeds the high watermark, it is trimmed to the low watermark.
+**/
+static void __pageFree(CDE_APP_IF* pCdeAppIf, HEAPCTRL* pCtrl, void* pPageBase, unsigned long long qwPages) {
+    HEAPDESC* pRun = (HEAPDESC*)pPageBase;
+
+    if (pCtrl->pZeroBase >= (PBYTE)pPageBase && pCtrl->pZeroBase < (PBYTE)pPageBase + qwPages * PAGESIZE)
+        pCtrl->pZeroBase = pCtrl->pZeroEnd = NULL;                  // zeroed range is gone
+
+    pRun->qwMagic = FREEMEM;
+    pRun->fInalterable = FALSE;
+    pRun->PageBase = (EFI_PHYSICAL_ADDRESS)pPageBase;
+    pRun->Pages = (unsigned long)qwPages;
+    pRun->pPred = NULL;
+    pRun->pSucc = pCtrl->pPageCache;
+    pCtrl->pPageCache = pRun;
+    pCtrl->qwPageCachePages += qwPages;
+
+    if (pCtrl->qwPageCachePages > _gCdeCfgHeapPageCacheHigh)
+        __pageFlush(pCdeAppIf, pCtrl, _gCdeCfgHeapPageCacheLow);
+}
+
+//
+// slab page lists, doubly linked through pPred/pSucc of SLABDESC
+//
+static void __slabLink(SLABDESC** ppHead, SLABDESC* pSlab) {
+    pSlab->pPred = NULL;
+    pSlab->pSucc = *ppHead;
+    if (NULL != pSlab->pSucc)
+        pSlab->pSucc->pPred = pSlab;
+    *ppHead = pSlab;
+}
+
+static void __slabUnlink(SLABDESC** ppHead, SLABDESC* pSlab) {
+    if (NULL != pSlab->pSucc)
+        pSlab->pSucc->pPred = pSlab->pPred;
+    if (NULL != pSlab->pPred)
+        pSlab->pPred->pSucc = pSlab->pSucc;
+    else
+        *ppHead = pSlab->pSucc;
+}
+
+/** __slabOf() - get the slab page of a pointer
+
+    @retval SLABDESC* if ptr is a slab slot
+            NULL otherwise
+**/
+static SLABDESC* __slabOf(void* ptr) {
+    SLABDESC* pSlab = (SLABDESC*)((size_t)ptr & ~((size_t)PAGESIZE - 1));
+
+    if ((void*)pSlab == ptr || pSlab->pSelf != pSlab || pSlab->qwMagic != SLABMEM)
+        return NULL;
+
+    return pSlab;
+}
+
+/** __slabAlloc() - get a slot of size bytes
+
+    size is a multiple of CDE_HEAP_ALIGN, not above SLABMAX
+**/
+static void* __slabAlloc(CDE_APP_IF* pCdeAppIf, HEAPCTRL* pCtrl, size_t size) {
+    unsigned cls = (unsigned)(size / CDE_HEAP_ALIGN) - 1;
+    SLABDESC* pSlab = pCtrl->rgpSlab[cls];
+    unsigned i, idx;
+    unsigned long long qwPages = 1;
+    int fZero;
+
+    if (NULL == pSlab) {
+
+        pSlab = (SLABDESC*)__pageAlloc(pCdeAppIf, pCtrl, &qwPages, 1, &fZero);
+        if (NULL == pSlab)
+            return NULL;
+
+        pSlab->pSelf = pSlab;                                       // NOTE: fInalterable is set by pMemAlloc()
+        pSlab->qwMagic = SLABMEM;
+        pSlab->wSlotSize = (unsigned short)size;
+        pSlab->nSlots = (unsigned short)((PAGESIZE - SLABHDX) / size);
+        pSlab->nFree = pSlab->nSlots;
+        for (i = 0; i < sizeof(pSlab->bmFree) / sizeof(pSlab->bmFree[0]); i++)
+            pSlab->bmFree[i] = 0ULL;
+        for (i = 0; i < pSlab->nSlots; i++)
+            pSlab->bmFree[i / 64] |= 1ULL << (i % 64);
+
+        __slabLink(&pCtrl->rgpSlab[cls], pSlab);
+    }
+
+    for (i = 0; 0 == pSlab->bmFree[i]; i++)
+        ;
+    idx = __heapLsb(pSlab->bmFree[i]);
+    pSlab->bmFree[i] &= ~(1ULL << idx);
+
+    if (0 == --pSlab->nFree) {
+        __slabUnlink(&pCtrl->rgpSlab[cls], pSlab);
+        __slabLink(&pCtrl->rgpSlabFull[cls], pSlab);
+    }
+
+    return (PBYTE)pSlab + SLABHDX + (64 * i + idx) * (size_t)pSlab->wSlotSize;
+}
+
+/** __slabFree() - release a slot
+
+    An empty slab page is returned, unless it is the last one of its size class.
+**/
+static void __slabFree(CDE_APP_IF* pCdeAppIf, HEAPCTRL* pCtrl, SLABDESC* pSlab, void* ptr) {
+    unsigned cls = pSlab->wSlotSize / CDE_HEAP_ALIGN - 1;
+    size_t ofs = (PBYTE)ptr - ((PBYTE)pSlab + SLABHDX);
+    size_t idx = ofs / pSlab->wSlotSize;
+
+    do {
+        if (0 != ofs % pSlab->wSlotSize || idx >= pSlab->nSlots)
+            break;                                                  // not a slot address
+
+        if (pSlab->bmFree[idx / 64] & (1ULL << (idx % 64)))
+            break;                                                  // slot is not allocated
+
+        pSlab->bmFree[idx / 64] |= 1ULL << (idx % 64);
+
+        if (0 == pSlab->nFree++) {
+            __slabUnlink(&pCtrl->rgpSlabFull[cls], pSlab);
+            __slabLink(&pCtrl->rgpSlab[cls], pSlab);
+        }
+
+        if (pSlab->nFree == pSlab->nSlots && FALSE == pSlab->fInalterable
+            && (NULL != pSlab->pPred || NULL != pSlab->pSucc)) {
+            __slabUnlink(&pCtrl->rgpSlab[cls], pSlab);
+            pSlab->pSelf = NULL;
+            __pageFree(pCdeAppIf, pCtrl, pSlab, 1);
+        }
+    } while (0);
+}
+
+/** __heapCopy() - copy a memory block in units of CDE_HEAP_ALIGN
+
+    pDst, pSrc and size are multiples of CDE_HEAP_ALIGN.
+    The copy runs upwards, so pDst may overlap pSrc if it is below.
+**/
+static void __heapCopy(void* pDst, const void* pSrc, size_t size) {
+    unsigned long long* pD = (unsigned long long*)pDst;
+    const unsigned long long* pS = (const unsigned long long*)pSrc;
+    size_t i;
+
+    for (i = 0; i < size / sizeof(unsigned long long); i += 2) {
+        pD[i + 0] = pS[i + 0];
+        pD[i + 1] = pS[i + 1];
+    }
+}
+
+/** __heapRunLink() - format a page run to hold a FREEMEM block and the ENDOFMEM block,
+    and link it in front of the HEAPDESC chain
+
+    @retval HEAPDESC* FREEMEM block, inserted into its size class list
+**/
+static HEAPDESC* __heapRunLink(HEAPCTRL* pCtrl, HEAPDESC* pHeapStart, void* pPageBase, unsigned long long qwPages) {
+    HEAPDESC* pTmpThis = (HEAPDESC*)pPageBase;
+    HEAPDESC* pTmpEnd = (HEAPDESC*)((PBYTE)&pTmpThis[0] + (qwPages * PAGESIZE) - sizeof(HEAPDESC));
+
+    pTmpThis->qwMagic = FREEMEM;
+    pTmpEnd->qwMagic = ENDOFMEM;
+
+    pTmpThis->PageBase = pTmpEnd->PageBase = (EFI_PHYSICAL_ADDRESS)pPageBase;
+    pTmpThis->Pages = pTmpEnd->Pages = (unsigned int)qwPages;
+
+    RUNPREV(pTmpEnd) = NULL;                                        // register the page run
+    RUNNEXT(pTmpEnd) = pCtrl->pRun;
+    if (NULL != RUNNEXT(pTmpEnd))
+        RUNPREV(RUNNEXT(pTmpEnd)) = pTmpEnd;
+    pCtrl->pRun = pTmpEnd;
+
+    pTmpEnd->pSucc = pHeapStart->pSucc;
+    if (NULL != pTmpEnd->pSucc)
+        pTmpEnd->pSucc->pPred = pTmpEnd;
+    pTmpEnd->pPred = pTmpThis;
+    pTmpThis->pSucc = pTmpEnd;
+    pTmpThis->pPred = pHeapStart;
+    pHeapStart->pSucc = pTmpThis;
+
+    __heapBinInsert(pCtrl, pTmpThis);
+
+    return pTmpThis;
+}
+
+/** __heapRunUnlink() - unregister a page run, given by its ENDOFMEM HEAPDESC
+**/
+static void __heapRunUnlink(HEAPCTRL* pCtrl, HEAPDESC* pEnd) {
+
+    if (NULL != RUNNEXT(pEnd))
+        RUNPREV(RUNNEXT(pEnd)) = RUNPREV(pEnd);
+    if (NULL != RUNPREV(pEnd))
+        RUNNEXT(RUNPREV(pEnd)) = RUNNEXT(pEnd);
+    else
+        pCtrl->pRun = RUNNEXT(pEnd);
+}
+
+/** __largeOf() - get the LARGEMEM descriptor of a pointer
+
+    The LARGEMEM HEAPDESC precedes the memory block and points to itself.
+    It is at the page base, unless the block is aligned above CDE_HEAP_ALIGN.
+
+    @retval HEAPDESC* if ptr is a LARGEMEM block
+            NULL otherwise
+**/
+static HEAPDESC* __largeOf(void* ptr) {
+    HEAPDESC* pLarge = &((HEAPDESC*)ptr)[-1];
+
+    if (pLarge->qwMagic != LARGEMEM || pLarge->CrumbleFront != (void*)pLarge || 0 != (pLarge->PageBase & (PAGESIZE - 1)))
+        return NULL;
+
+    return pLarge;
+}
+
+/** __largeAlloc() - get a page run of its own for a block of size bytes
+
+    alignment is a power of two. Blocks aligned to PAGESIZE and above are page aligned
+    directly, the LARGEMEM HEAPDESC resides at the end of the preceding page.
+**/
+static void* __largeAlloc(CDE_APP_IF* pCdeAppIf, HEAPCTRL* pCtrl, size_t size, size_t alignment) {
+    size_t nOfs = (sizeof(HEAPDESC) + alignment - 1) & ~(alignment - 1);   // max. offset of the block from the page base
+    unsigned long long qwPages = ((unsigned long long)size + nOfs + PAGESIZE - 1) / PAGESIZE;
+    HEAPDESC* pPageBase = NULL, * pLarge = NULL;
+    int fZero = FALSE;
+
+    if (qwPages < CDE_MEMALLOC_PAGES_MAX)
+        pPageBase = __pageAlloc(pCdeAppIf, pCtrl, &qwPages, qwPages, &fZero);
+
+    if (NULL != pPageBase) {
+        pLarge = &((HEAPDESC*)(((size_t)&pPageBase[1] + alignment - 1) & ~(alignment - 1)))[-1];
+
+        pLarge->fInalterable = pPageBase->fInalterable;             // NOTE: fInalterable is set by pMemAlloc()
+        pLarge->CrumbleFront = pLarge;
+        pLarge->qwMagic = LARGEMEM;
+        pLarge->PageBase = (EFI_PHYSICAL_ADDRESS)pPageBase;
+        pLarge->Pages = (unsigned long)qwPages;
+        pLarge->pPred = NULL;
+        pLarge->pSucc = pCtrl->pLarge;
+        if (NULL != pLarge->pSucc)
+            pLarge->pSucc->pPred = pLarge;
+        pCtrl->pLarge = pLarge;
+        pLarge = &pLarge[1];
+
+        pCtrl->pKnownZero = fZero ? pLarge : NULL;
+    }
+
+    return pLarge;
+}
+
+/** __largeFree() - return the page run of a LARGEMEM block
+
+    Inalterable pages (PEI) are converted to a page run of the HEAPDESC chain instead.
+**/
+static void __largeFree(CDE_APP_IF* pCdeAppIf, HEAPCTRL* pCtrl, HEAPDESC* pLarge, HEAPDESC* pHeapStart) {
+
+    if (NULL != pLarge->pSucc)
+        pLarge->pSucc->pPred = pLarge->pPred;
+    if (NULL != pLarge->pPred)
+        pLarge->pPred->pSucc = pLarge->pSucc;
+    else
+        pCtrl->pLarge = pLarge->pSucc;
+
+    pLarge->qwMagic = FREEMEM;
+
+    if (FALSE == pLarge->fInalterable) {
+        pCtrl->Count.qwPagesFree += pLarge->Pages;
+        pCdeAppIf->pCdeServices->pMemFree(pCdeAppIf, pLarge->PageBase, (unsigned int)pLarge->Pages);
+    }
+    else
+        __heapRunLink(pCtrl, pHeapStart, (void*)pLarge->PageBase, pLarge->Pages);
+}
+
+/** __heapZeroClip() - remove an ALLOCMEM block and its successing HEAPDESC from the zeroed range
+**/
+static void __heapZeroClip(HEAPCTRL* pCtrl, HEAPDESC* pThis) {
+    PBYTE pEnd = (PBYTE)&pThis->pSucc[1];
+
+    if (pEnd > pCtrl->pZeroBase && (PBYTE)pThis < pCtrl->pZeroEnd) {
+        pCtrl->pZeroBase = pEnd;
+        if (pCtrl->pZeroBase >= pCtrl->pZeroEnd)
+            pCtrl->pZeroBase = pCtrl->pZeroEnd = NULL;
+    }
+}
+
+/** __heapAlloc() - allocate a HEAPDESC block of size bytes
+
+    alignment is a power of two. If it is above CDE_HEAP_ALIGN, the leading slack
+    of the FREEMEM block is split off into a FREEMEM block of its own.
+
+    @retval HEAPDESC* of the ALLOCMEM block
+            NULL on FAIL
+**/
+static HEAPDESC* __heapAlloc(CDE_APP_IF* pCdeAppIf, HEAPCTRL* pCtrl, size_t size, size_t alignment, HEAPDESC* pHeapStart) {
+    size_t nNeed = alignment > CDE_HEAP_ALIGN ? size + alignment + sizeof(HEAPDESC) : size;
+    HEAPPOOL* pPool = __heapPoolOwned(pCdeAppIf, pCtrl);
+    HEAPDESC* pThis = __heapBinFind(pCtrl, pPool, nNeed), * pSucc;
+    int fZero;
+
+    do {
+        if (NULL == pThis) {
+            //
+            // get a new page run, that holds a FREEMEM block and the ENDOFMEM block,
+            // and link it in front of the HEAPDESC chain
+            //
+            unsigned long long qwPages = ((unsigned long long)nNeed + 3 * sizeof(HEAPDESC) + PAGESIZE - 1) / PAGESIZE;
+            HEAPDESC* pPageBase;
+
+            if (NULL != pPool)
+                break;                                              // the fixed pool doesn't grow
+
+            pPageBase = qwPages >= CDE_MEMALLOC_PAGES_MAX ? NULL : __pageAlloc(pCdeAppIf, pCtrl, &qwPages, 2 * qwPages, &fZero);
+            if (NULL == pPageBase)
+                break;
+
+            pThis = __heapRunLink(pCtrl, pHeapStart, pPageBase, qwPages);
+
+            if (fZero) {
+                pCtrl->pZeroBase = (PBYTE)&pThis[1];
+                pCtrl->pZeroEnd = (PBYTE)pThis->pSucc;
+            }
+        }
+
+        __heapBinRemove(pCtrl, pThis);
+
+        if (alignment > CDE_HEAP_ALIGN) {
+            PBYTE pData = (PBYTE)&pThis[1];
+            PBYTE pAligned = (PBYTE)(((size_t)pData + alignment - 1) & ~(alignment - 1));
+
+            while (pAligned != pData && (size_t)(pAligned - pData) < sizeof(HEAPDESC))
+                pAligned += alignment;                              // leading slack must hold a HEAPDESC
+
+            if (pAligned != pData) {
+                pSucc = &((HEAPDESC*)pAligned)[-1];
+
+                pSucc->pSucc = pThis->pSucc;
+                pSucc->pSucc->pPred = pSucc;
+                pSucc->pPred = pThis;
+                pThis->pSucc = pSucc;
+
+                __heapBinInsert(pCtrl, pThis);                      // leading slack remains FREEMEM
+                pThis = pSucc;
+            }
+        }
+
+        pThis->qwMagic = ALLOCMEM;
+
+        if (BLKSIZE(pThis) >= size + sizeof(HEAPDESC)) {            // can hold additional free HEAPDESC
+            pSucc = (HEAPDESC*)((PBYTE)&pThis[1] + size);
+
+            pSucc->qwMagic = FREEMEM;
+
+            pSucc->pSucc = pThis->pSucc;    //1
+            pSucc->pSucc->pPred = pSucc;    //2
+            pSucc->pPred = pThis;           //3
+            pThis->pSucc = pSucc;           //4
+
+            __heapBinInsert(pCtrl, pSucc);
+        }
+
+        if ((PBYTE)&pThis[1] >= pCtrl->pZeroBase && (PBYTE)pThis->pSucc <= pCtrl->pZeroEnd)
+            pCtrl->pKnownZero = &pThis[1];
+
+        __heapZeroClip(pCtrl, pThis);
+
+    } while (0);
+
+    return pThis;
+}
+
+/** __tinyRegion() - get a compact heap region, that holds a block of need bytes
+
+    The region is formatted to a single free block and the end marker, a TINYHDR
+    of size 0 marked allocated.
+**/
+static TINYDESC* __tinyRegion(CDE_APP_IF* pCdeAppIf, HEAPCTRL* pCtrl, size_t need) {
+    unsigned long long qwPages = ((unsigned long long)need + TINYHDX + sizeof(TINYHDR) + PAGESIZE - 1) / PAGESIZE;
+    TINYDESC* pTiny = NULL;
+    TINYHDR* pHdr, * pEnd;
+    PBYTE pLimit;
+    int fZero;
+
+    if (qwPages < CDE_MEMALLOC_PAGES_MAX)
+        pTiny = __pageAlloc(pCdeAppIf, pCtrl, &qwPages, qwPages, &fZero);
+
+    if (NULL != pTiny) {
+
+        pLimit = (PBYTE)pTiny + qwPages * PAGESIZE;
+
+        pTiny->pSelf = pTiny;                                       // NOTE: fInalterable is set by pMemAlloc()
+        pTiny->qwMagic = TINYMEM;
+        pTiny->Pages = (unsigned long)qwPages;
+        pTiny->pSucc = pCtrl->pTiny;
+        pCtrl->pTiny = pTiny;
+
+        pHdr = (TINYHDR*)((PBYTE)pTiny + TINYHDX);
+        pEnd = (TINYHDR*)(pLimit - sizeof(TINYHDR));
+        pHdr->cbSize = (PBYTE)pEnd - (PBYTE)pHdr;
+        pHdr->cbPrev = 0;
+        pEnd->cbSize = 1;
+        pEnd->cbPrev = pHdr->cbSize;
+
+        if (NULL == pCtrl->pTinyBase || (PBYTE)pTiny < pCtrl->pTinyBase)
+            pCtrl->pTinyBase = (PBYTE)pTiny;
+        if (pLimit > pCtrl->pTinyEnd)
+            pCtrl->pTinyEnd = pLimit;
+
+        pCtrl->pSelf = pCtrl;
+    }
+
+    return pTiny;
+}
+
+/** __tinyOf() - get the compact heap block of a pointer
+
+    @retval TINYHDR* if ptr is an allocated compact heap block
+            NULL otherwise
+**/
+static TINYHDR* __tinyOf(HEAPCTRL* pCtrl, void* ptr) {
+    TINYDESC* pTiny;
+    TINYHDR* pHdr = &((TINYHDR*)ptr)[-1];
+
+    if ((PBYTE)ptr < pCtrl->pTinyBase || (PBYTE)ptr >= pCtrl->pTinyEnd || 0 != ((size_t)ptr & (CDE_TINY_ALIGN - 1)))
+        return NULL;
+
+    for (pTiny = pCtrl->pTiny; NULL != pTiny; pTiny = pTiny->pSucc)
+        if ((PBYTE)pHdr >= (PBYTE)pTiny + TINYHDX && (PBYTE)ptr < (PBYTE)pTiny + (size_t)pTiny->Pages * PAGESIZE)
+            return 0 != (pHdr->cbSize & 1) && 0 != TINYSIZE(pHdr) ? pHdr : NULL;
+
+    return NULL;
+}
+
+/** __tinyAlloc() - get a compact heap block of size bytes, first fit
+
+    The remainder of a free block is split off, if it can hold a granule.
+**/
+static void* __tinyAlloc(CDE_APP_IF* pCdeAppIf, HEAPCTRL* pCtrl, size_t size) {
+    size_t need = ((size + CDE_TINY_ALIGN - 1) & ~(CDE_TINY_ALIGN - 1)) + sizeof(TINYHDR);
+    TINYDESC* pTiny;
+    TINYHDR* pHdr = NULL;
+    TINYHDR* pRest;
+
+    for (pTiny = pCtrl->pTiny; NULL != pTiny; pTiny = pTiny->pSucc) {
+
+        for (pHdr = (TINYHDR*)((PBYTE)pTiny + TINYHDX); 0 != TINYSIZE(pHdr); pHdr = TINYNEXT(pHdr))
+            if (0 == (pHdr->cbSize & 1) && pHdr->cbSize >= need)
+                break;
+
+        if (0 != TINYSIZE(pHdr))
+            break;
+
+        pHdr = NULL;                                                // end marker reached
+    }
+
+    if (NULL == pHdr) {
+        if (NULL == (pTiny = __tinyRegion(pCdeAppIf, pCtrl, need)))
+            return NULL;
+        pHdr = (TINYHDR*)((PBYTE)pTiny + TINYHDX);
+    }
+
+    if (pHdr->cbSize - need >= sizeof(TINYHDR) + CDE_TINY_ALIGN) {
+        pRest = (TINYHDR*)((PBYTE)pHdr + need);
+        pRest->cbSize = pHdr->cbSize - need;
+        pRest->cbPrev = need;
+        TINYNEXT(pRest)->cbPrev = pRest->cbSize;
+        pHdr->cbSize = need;
+    }
+
+    pHdr->cbSize |= 1;
+
+    return &pHdr[1];
+}
+
+/** __tinyFree() - release a compact heap block, fuse with free neighbours
+**/
+static void __tinyFree(HEAPCTRL* pCtrl, TINYHDR* pHdr) {
+    TINYHDR* pNext;
+
+    pHdr->cbSize &= ~(size_t)1;
+
+    pNext = TINYNEXT(pHdr);
+    if (0 == (pNext->cbSize & 1))                                   // NOTE: the end marker is allocated
+        pHdr->cbSize += pNext->cbSize;
+
+    if (0 != pHdr->cbPrev && 0 == (TINYPREV(pHdr)->cbSize & 1)) {
+        TINYPREV(pHdr)->cbSize += pHdr->cbSize;
+        pHdr = TINYPREV(pHdr);
+    }
+
+    TINYNEXT(pHdr)->cbPrev = pHdr->cbSize;
+}
+
+/** __tinyAlignedAlloc() - get an aligned compact heap block
+
+    The block is allocated with room for the alignment and a leading free block,
+    that is split off and released.
+**/
+static void* __tinyAlignedAlloc(CDE_APP_IF* pCdeAppIf, HEAPCTRL* pCtrl, size_t size, size_t alignment) {
+    PBYTE p = __tinyAlloc(pCdeAppIf, pCtrl, size + alignment + 2 * sizeof(TINYHDR));
+    PBYTE q;
+    TINYHDR* pLead, * pHdr;
+
+    if (NULL == p)
+        return NULL;
+
+    pLead = &((TINYHDR*)p)[-1];
+    q = (PBYTE)(((size_t)p + 2 * sizeof(TINYHDR) + alignment - 1) & ~(alignment - 1));
+    pHdr = &((TINYHDR*)q)[-1];
+
+    pHdr->cbSize = ((PBYTE)TINYNEXT(pLead) - (PBYTE)pHdr) | 1;
+    pHdr->cbPrev = (PBYTE)pHdr - (PBYTE)pLead;
+    TINYNEXT(pHdr)->cbPrev = TINYSIZE(pHdr);
+    pLead->cbSize = pHdr->cbPrev | 1;
+    __tinyFree(pCtrl, pLead);
+
+    return q;
+}
+
+/** __tinyMigrated() - translate a pointer into the compact heap before migration
+**/
+static void* __tinyMigrated(HEAPCTRL* pCtrl, void* ptr) {
+
+    if ((PBYTE)ptr >= pCtrl->pCarBase && (PBYTE)ptr < pCtrl->pCarEnd)
+        ptr = (PBYTE)ptr + ((size_t)pCtrl->pTinyBase - (size_t)pCtrl->pCarBase);
+
+    return ptr;
+}
+
+/** __heapRestart() - restart memory allocation if switched from Pre-Memory-PEI to Post-Memory-PEI
+
+    If HEAPCTRL was migrated to permanent memory by the PEI core, along with the compact
+    heap regions, the regions are re-registered at the migrated address. The former address
+    range is kept in pCarBase/pCarEnd to translate pointers of the application.
+    Everything else is restarted.
+**/
+static void __heapRestart(CDE_APP_IF* pCdeAppIf, HEAPDESC* pHeapStart) {
+    HEAPCTRL* pCtrl = &pCdeAppIf->pCdeServices->HeapCtrl;
+    long long start = (long long)pHeapStart;
+    long long succ = (long long)pHeapStart->pSucc;
+
+    if (NULL != pCtrl->pSelf && pCtrl->pSelf != (void*)pCtrl) {
+
+        size_t ofs = (size_t)pCtrl - (size_t)pCtrl->pSelf;          // migration offset
+        TINYDESC* pTiny = (TINYDESC*)((size_t)pCtrl->pTiny + ofs), * p;
+        PBYTE pCarBase = pCtrl->pTinyBase;
+        PBYTE pCarEnd = pCtrl->pTinyEnd;
+
+        for (p = pTiny; NULL != p; p = p->pSucc) {
+            p->pSelf = p;
+            if (NULL != p->pSucc)
+                p->pSucc = (TINYDESC*)((size_t)p->pSucc + ofs);
+        }
+
+        pCdeAppIf->pCdeServices->HeapStart = (HEAPDESC){ (void*)-1,ENDOFMEM,1,NULL,NULL,0,0,(void*)-1 };//heapdesc;
+        pCdeAppIf->pCdeServices->HeapCtrl = (HEAPCTRL){ {0} };
+
+        pCtrl->pTiny = pTiny;
+        pCtrl->pTinyBase = pCarBase + ofs;
+        pCtrl->pTinyEnd = pCarEnd + ofs;
+        pCtrl->pCarBase = pCarBase;
+        pCtrl->pCarEnd = pCarEnd;
+        pCtrl->pSelf = pCtrl;
+        return;
+    }
+
+    if (start > 0 && succ < 0) {
+
+        pCdeAppIf->pCdeServices->HeapStart = (HEAPDESC){ (void*)-1,ENDOFMEM,1,NULL,NULL,0,0,(void*)-1 };//heapdesc;
+        pCdeAppIf->pCdeServices->HeapCtrl = (HEAPCTRL){ {0} };
+    }
+}
+
 static void __insertFree(HEAPDESC* pThis,
     HEAPDESC* pSucc,
     HEAPDESC* pFree,
@@ -48,37 +854,169 @@ static void __insertFree(HEAPDESC* pThis,
 
 //  2. free that free block (fuse with  successing free block)
 
-    pFree->qwMagic = FREEMEM;
-    _cdeMemRealloc(pCdeAppIf, &pFree[1], 0, pHeapStart);	// fuse with bounding free block //KG20160402
+    pFree->qwMagic = ALLOCMEM;                                  // free() accepts ALLOCMEM only
+    __cdeMemRealloc(pCdeAppIf, &pFree[1], 0, pHeapStart);	// fuse with bounding free block //KG20160402
+}
+
+/** __heapEntry() - count the call and record it in the heap profiler, if started
+
+    fAligned selects __cdeMemAlignedRealloc(), otherwise __cdeMemRealloc().
+    The allocation site passed in HEAPCTRL.pSite takes precedence over pSite.
+**/
+static void* __heapEntry(CDE_APP_IF* pCdeAppIf, void* pSite, void* ptr, size_t size, int fAligned, size_t alignment, HEAPDESC* pHeapStart) {
+    HEAPCTRL* pCtrl = &pCdeAppIf->pCdeServices->HeapCtrl;
+    CDEHEAPPROFREC Rec;
+
+    if (NULL == ptr)
+        pCtrl->Count.qwMalloc++;
+    else if (0 == size)
+        pCtrl->Count.qwFree++;
+    else
+        pCtrl->Count.qwRealloc++;
+
+    if (NULL != pCtrl->pSite) {
+        pSite = pCtrl->pSite;
+        pCtrl->pSite = NULL;
+    }
+
+    if (NULL == pCtrl->pProf)
+        return FALSE == fAligned
+            ? __cdeMemRealloc(pCdeAppIf, ptr, size, pHeapStart)
+            : __cdeMemAlignedRealloc(pCdeAppIf, ptr, size, alignment, pHeapStart);
+
+    Rec.pSite = pSite;
+    Rec.ptr = ptr;
+    Rec.size = size;
+    Rec.qwTsc = pCdeAppIf->pCdeServices->pGetTsc(pCdeAppIf);
+
+    Rec.pRet = FALSE == fAligned
+        ? __cdeMemRealloc(pCdeAppIf, ptr, size, pHeapStart)
+        : __cdeMemAlignedRealloc(pCdeAppIf, ptr, size, alignment, pHeapStart);
+
+    Rec.qwTicks = pCdeAppIf->pCdeServices->pGetTsc(pCdeAppIf) - Rec.qwTsc;
+
+    _cdeHeapProfRecord(pCdeAppIf, &Rec);
+
+    return Rec.pRet;
 }
 
 /** _cdeMemRealloc()
 
 Synopsis
 
-    void* _cdeMemRealloc(
-        CDE_APP_IF* pCdeAppIf,
-        void* ptr,
-        size_t size,
-        HEAPDESC* pHeapStart
-    )
+    void* _cdeMemRealloc(
+        CDE_APP_IF* pCdeAppIf,
+        void* ptr,
+        size_t size,
+        HEAPDESC* pHeapStart
+    )
+
+Description
+
+    Toro C Library common memory suballocator
+
+    FREEMEM blocks are held in size class lists (HEAPCTRL), so that malloc()
+    doesn't walk the HEAPDESC chain, but picks a block in constant time.
+    New page runs are linked in front of the HEAPDESC chain.
+    Emptied page runs are retained in a page cache for reuse.
+
+    Blocks of CDE_HEAP_LARGE_MIN bytes and above get page runs of their own,
+    that are returned immediately by free().
+
+    Blocks up to SLABMAX bytes are taken from slab pages, without HEAPDESC.
+
+    realloc() grows a block in place into a free successor and/or a free
+    predecessor, before it moves the data to a new block.
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[in] void* ptr
+    @param[in] size_t size
+    @param[in] HEAPDESC * pHeapStart
+
+    @retval void * memory block
+            NULL on FAIL
+
+**/
+void* _cdeMemRealloc(
+    CDE_APP_IF* pCdeAppIf,
+    IN void* ptr,   /* input pointer for realloc */
+    IN size_t size, /*  input size for realloc*/
+    HEAPDESC* pHeapStart
+)
+{
+    return __heapEntry(pCdeAppIf, _ReturnAddress(), ptr, size, FALSE, 0, pHeapStart);
+}
+
+/** _cdeMemSizedFree()
+
+Synopsis
+
+    void _cdeMemSizedFree(
+        CDE_APP_IF* pCdeAppIf,
+        void* ptr,
+        size_t size,
+        HEAPDESC* pHeapStart
+    )
+
+Description
+
+    Release a memory block of known size, C++ sized operator delete().
+
+    Blocks up to SLABMAX bytes are released to their slab page directly, identified
+    by the page header of ptr, without the compact heap and LARGEMEM lookups of the
+    free() path. size only selects this path, the size class is taken from the slab
+    page. Other blocks, and all blocks while the heap profiler is started, are
+    released by _cdeMemRealloc().
+    NULL is ignored.
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[in] void* ptr
+    @param[in] size_t size : size passed to malloc()
+    @param[in] HEAPDESC * pHeapStart
+
+    @retval void
+
+**/
+void _cdeMemSizedFree(
+    CDE_APP_IF* pCdeAppIf,
+    IN void* ptr,
+    IN size_t size,
+    HEAPDESC* pHeapStart
+)
+{
+    HEAPCTRL* pCtrl = &pCdeAppIf->pCdeServices->HeapCtrl;
+    SLABDESC* pSlab;
+
+    do {
+
+        if (NULL == ptr)
+            break;
 
-Description
+        if (size > SLABMAX || NULL != pCtrl->pProf || NULL != pCtrl->pTiny) {
+            __heapEntry(pCdeAppIf, _ReturnAddress(), ptr, 0, FALSE, 0, pHeapStart);
+            break;
+        }
 
-    Toro C Library common memory suballocator
+        pCtrl->Count.qwFree++;
+        pCtrl->pSite = NULL;
 
-Returns
+        __heapRestart(pCdeAppIf, pHeapStart);
 
-    @param[in] CDE_APP_IF* pCdeAppIf
-    @param[in] void* ptr
-    @param[in] size_t size
-    @param[in] HEAPDESC * pHeapStart
+        if (NULL != (pSlab = __slabOf(ptr)))
+            __slabFree(pCdeAppIf, pCtrl, pSlab, ptr);
+        else
+            __cdeMemRealloc(pCdeAppIf, ptr, 0, pHeapStart);         // e.g. aligned or from Pre-Memory-PEI
 
-    @retval void * memory block
-            NULL on FAIL
+    } while (0);
+}
 
+/** __cdeMemRealloc() - _cdeMemRealloc() without running counters and profiling, called internally
 **/
-void* _cdeMemRealloc(
+static void* __cdeMemRealloc(
     CDE_APP_IF* pCdeAppIf,
     IN void* ptr,   /* input pointer for realloc */
     IN size_t size, /*  input size for realloc*/
@@ -87,31 +1025,113 @@ void* _cdeMemRealloc(
 {
 
     HEAPDESC* pThis = NULL/*,*pLast,*pPred*/, * pSucc, * pFree;
-    unsigned int i;
+    HEAPCTRL* pCtrl = &pCdeAppIf->pCdeServices->HeapCtrl;
 
-    size_t nSizeW_AddHeapDesc;
-    size_t nSizeWOAddHeapDesc;
 #define HDX sizeof(HEAPDESC)
 #define SIZ size
-#define TBS ((unsigned)((PBYTE)&pThis->pSucc[0] - (PBYTE)&pThis[1]))    /* THIS BLOCK SIZE */
-#define XBS (pThis->pSucc->qwMagic == FREEMEM ? ((unsigned)((PBYTE)&pThis->pSucc->pSucc[0] - (PBYTE)&pThis[1])) : 0) /* EXTENDABLE BLOCK SIZE */
+#define TBS ((size_t)((PBYTE)&pThis->pSucc[0] - (PBYTE)&pThis[1]))    /* THIS BLOCK SIZE */
+#define XBS (pThis->pSucc->qwMagic == FREEMEM ? ((size_t)((PBYTE)&pThis->pSucc->pSucc[0] - (PBYTE)&pThis[1])) : 0) /* EXTENDABLE BLOCK SIZE */
 
     //
     // restart memory allocation if switched from Pre-Memory-PEI to Post-Memory-PEI
     //
-    if (1/**/) {
-        long long start = (long long)pHeapStart;
-        long long succ = (long long)pHeapStart->pSucc;
+    __heapRestart(pCdeAppIf, pHeapStart);
 
-        if (start > 0 && succ < 0) {
+    pCtrl->pKnownZero = NULL;
+
+    ptr = __tinyMigrated(pCtrl, ptr);
 
-            pCdeAppIf->pCdeServices->HeapStart = (HEAPDESC){ (void*)-1,ENDOFMEM,1,NULL,NULL,0,0,(void*)-1 };//heapdesc;
-        }
-    }
     do {
 
+        if (size > ~(size_t)0 - 4 * PAGESIZE)                       // prevent overflow of size calculations
+            break;
+
+        //
+        // round up to the block size granularity, keep all HEAPDESC aligned
+        //
+        size = (size + CDE_HEAP_ALIGN - 1) & ~((size_t)CDE_HEAP_ALIGN - 1);
+
         if (ptr != NULL) 
         {
+            TINYHDR* pHdr = NULL == pCtrl->pTiny ? NULL : __tinyOf(pCtrl, ptr);
+            SLABDESC* pSlab;
+
+            if (NULL != pHdr)
+            {
+                size_t nCap = TINYSIZE(pHdr) - sizeof(TINYHDR);
+
+                pThis = NULL;
+
+                if (size == 0)                                          // free()
+                    __tinyFree(pCtrl, pHdr);
+                else if (size <= nCap)                                  // fits into the block
+                    return ptr;
+                else {
+                    unsigned char* pNewBuf = __cdeMemRealloc(pCdeAppIf, 0, size, pHeapStart);
+
+                    if (pNewBuf != NULL) {
+                        __heapCopy(pNewBuf, ptr, nCap);
+                        __tinyFree(pCtrl, pHdr);
+                    }
+                    return pNewBuf;
+                }
+                break;
+            }
+
+            pSlab = __slabOf(ptr);
+
+            if (NULL != pSlab)
+            {
+                pThis = NULL;
+
+                if (size == 0)                                          // free()
+                    __slabFree(pCdeAppIf, pCtrl, pSlab, ptr);
+                else if (size <= pSlab->wSlotSize)                      // fits into the slot
+                    return ptr;
+                else {
+                    unsigned char* pNewBuf = __cdeMemRealloc(pCdeAppIf, 0, size, pHeapStart);
+
+                    if (pNewBuf != NULL) {
+                        __heapCopy(pNewBuf, ptr, pSlab->wSlotSize);
+                        __slabFree(pCdeAppIf, pCtrl, pSlab, ptr);
+                    }
+                    return pNewBuf;
+                }
+                break;
+            }
+
+            pThis = __largeOf(ptr);
+
+            if (NULL != pThis)
+            {
+                size_t nCap = (size_t)(pThis->PageBase + (unsigned long long)pThis->Pages * PAGESIZE - (size_t)ptr);
+
+                if (size == 0)                                          // free()
+                    __largeFree(pCdeAppIf, pCtrl, pThis, pHeapStart);
+                else if (size <= nCap && size >= CDE_HEAP_LARGE_MIN && size > nCap / 2)  // fits into the page run
+                    return ptr;
+                else {
+                    unsigned char* pNewBuf = NULL;
+
+                    if (size > nCap && NULL == __heapPoolOwned(pCdeAppIf, pCtrl)) {    // grow by 1.5 at least, amortize step-wise growth
+                        size_t nGrow = nCap + nCap / 2;
+
+                        pNewBuf = __largeAlloc(pCdeAppIf, pCtrl, size > nGrow ? size : nGrow, CDE_HEAP_ALIGN);
+                    }
+
+                    if (pNewBuf == NULL)
+                        pNewBuf = __cdeMemRealloc(pCdeAppIf, 0, size, pHeapStart);
+
+                    if (pNewBuf != NULL) {
+                        __heapCopy(pNewBuf, ptr, size < nCap ? size : nCap);
+                        __largeFree(pCdeAppIf, pCtrl, pThis, pHeapStart);
+                    }
+                    return pNewBuf;
+                }
+                pThis = NULL;
+                break;
+            }
+
             if (size != 0) 
             {
                 static enum ACTION {
@@ -151,6 +1171,7 @@ void* _cdeMemRealloc(
 
                     case REA_STRETCH_W_DESC: {
 
+                        __heapBinRemove(pCtrl, pThis->pSucc);                          // successor is consumed
                         pSucc = pThis->pSucc->pSucc; 						        // the only thing we need to know
                         pFree = (HEAPDESC*)((PBYTE)&pThis[1] + size);
 
@@ -159,6 +1180,7 @@ void* _cdeMemRealloc(
                         break;
                     }
                     case REA_STRETCH_WO_DESC: {
+                        __heapBinRemove(pCtrl, pThis->pSucc);                          // successor is consumed
                         pSucc = pThis->pSucc->pSucc;
                         pThis->pSucc = pSucc;
                         pSucc->pPred = pThis;
@@ -166,14 +1188,40 @@ void* _cdeMemRealloc(
                     }
                     case REA_MALLOC_MOVE: {
 
-                        unsigned char* pNewBuf, * pOldBuf;
-                        pNewBuf = _cdeMemRealloc(pCdeAppIf, 0, size, pHeapStart);	    // allocate new size KG20160402
-                        pOldBuf = (unsigned char*)&pThis[1];						// get data area of ald buffer
+                        unsigned char* pNewBuf, * pOldBuf = (unsigned char*)&pThis[1];  // get data area of old buffer
+                        HEAPDESC* pPred = pThis->pPred;
+                        HEAPDESC* pEnd = pThis->pSucc->qwMagic == FREEMEM ? pThis->pSucc->pSucc : pThis->pSucc;
+
+                        if (pPred->qwMagic == FREEMEM && (size_t)((PBYTE)pEnd - (PBYTE)&pPred[1]) >= size) {
+                            //
+                            // grow backwards into the free predecessor (and the free successor),
+                            // slide the data down into the joint block
+                            //
+                            size_t nOld = TBS;
+
+                            __heapBinRemove(pCtrl, pPred);                                  // predecessor is consumed
+                            if (pEnd != pThis->pSucc)
+                                __heapBinRemove(pCtrl, pThis->pSucc);                       // successor is consumed
+
+                            pPred->pSucc = pEnd;
+                            pEnd->pPred = pPred;
+                            pPred->qwMagic = ALLOCMEM;
+
+                            __heapCopy(&pPred[1], pOldBuf, nOld);
+                            pThis = pPred;
+
+                            if ((SIZ + HDX + 1) <= TBS) {                                   // split off the remainder
+                                pFree = (HEAPDESC*)((PBYTE)&pThis[1] + size);
+                                __insertFree(pThis, pEnd, pFree, pHeapStart, pCdeAppIf);
+                            }
+                            break;
+                        }
+
+                        pNewBuf = __cdeMemRealloc(pCdeAppIf, 0, size, pHeapStart);	    // allocate new size KG20160402
 
                         if (pNewBuf != NULL) {
-                            for (i = 0; i < TBS; i++)
-                                pNewBuf[i] = pOldBuf[i];
-                            _cdeMemRealloc(pCdeAppIf, &pThis[1], 0, pHeapStart);		// fuse with bounding free block //KG20160402
+                            __heapCopy(pNewBuf, pOldBuf, TBS);
+                            __cdeMemRealloc(pCdeAppIf, &pThis[1], 0, pHeapStart);		// fuse with bounding free block //KG20160402
                             pThis = &((HEAPDESC*)pNewBuf)[-1];
                         }
                         else {
@@ -183,6 +1231,9 @@ void* _cdeMemRealloc(
                         break;
                     }
                 }//switch (action)
+
+                if (NULL != pThis)
+                    __heapZeroClip(pCtrl, pThis);                   // block may have grown into the zeroed range
                 break;
             }
             //
@@ -197,22 +1248,28 @@ void* _cdeMemRealloc(
                     pThis->qwMagic = FREEMEM;
 
                     if (pThis->pSucc->qwMagic == FREEMEM/*ree*/) {								// fuse with successor
+                        __heapBinRemove(pCtrl, pThis->pSucc);
                         pThis->pSucc = pThis->pSucc->pSucc;
                         pThis->pSucc->pPred = pThis;
                     }
 
                     if (pThis->pPred != NULL && pThis->pPred->qwMagic == FREEMEM) {			// fuse with predessor -> remove pThis
+                        __heapBinRemove(pCtrl, pThis->pPred);
                         pThis->pPred->pSucc = pThis->pSucc;
                         pThis->pSucc->pPred = pThis->pPred;
 
                         pThis = pThis->pPred;
                     }
                     if (FALSE == pThis->fInalterable && (pThis->pPred->qwMagic == ENDOFMEM) && (pThis->pSucc->qwMagic == ENDOFMEM)) {	//free pages
+                        __heapRunUnlink(pCtrl, pThis->pSucc);
                         pThis->pPred->pSucc = pThis->pSucc->pSucc;
                         if (NULL != pThis->pSucc->pSucc) {
                             pThis->pSucc->pSucc->pPred = pThis->pPred;
                         }
-                        pCdeAppIf->pCdeServices->pMemFree(pCdeAppIf, pThis->PageBase, (unsigned int)pThis->Pages);
+                        __pageFree(pCdeAppIf, pCtrl, (void*)pThis->PageBase, pThis->Pages);
+                    }
+                    else {
+                        __heapBinInsert(pCtrl, pThis);
                     }
                 }/*KG20170815_1 don't do anything if not own memory */
             }
@@ -223,72 +1280,430 @@ void* _cdeMemRealloc(
         //
         // malloc()
         //
-            size = size == 0 ? 1 : size; //KG20170603 malloc(0),realloc(0,0) returns a pointer != 0
+            int fPool = NULL != __heapPoolOwned(pCdeAppIf, pCtrl);     // the driver allocates from its fixed pool
 
-            pThis = pHeapStart;
+            size = size == 0 ? CDE_HEAP_ALIGN : size; //KG20170603 malloc(0),realloc(0,0) returns a pointer != 0
 
-            do {
-                if (pThis->qwMagic == FREEMEM) {
-                    nSizeWOAddHeapDesc = (PBYTE)(&pThis->pSucc[0]) - (PBYTE)(&pThis[1]);	// size with/out additional heap descriptor
-                    nSizeW_AddHeapDesc = (PBYTE)(&pThis->pSucc[0]) - (PBYTE)(&pThis[2]);	// size with/    additional heap descriptor
-                    nSizeWOAddHeapDesc = nSizeWOAddHeapDesc > (size_t)(&pThis->pSucc[0]) ? 0 : nSizeWOAddHeapDesc; // avoid negative numbers on unsigned
-                    nSizeW_AddHeapDesc = nSizeW_AddHeapDesc > (size_t)(&pThis->pSucc[0]) ? 0 : nSizeW_AddHeapDesc; // avoid negative numbers on unsigned
+            if (FALSE != pCtrl->fTinyHeap)                              // Pre-Memory-PEI
+                return __tinyAlloc(pCdeAppIf, pCtrl, size);
 
-                    if (nSizeWOAddHeapDesc >= size && nSizeW_AddHeapDesc < size) {	// exact match
-                        pThis->qwMagic = ALLOCMEM;
-                        break;
-                    }
+            if (size <= SLABMAX && FALSE == fPool) {
+                void* pSlot = __slabAlloc(pCdeAppIf, pCtrl, size);
 
-                    if (nSizeW_AddHeapDesc >= size) {  // can hold additional free HEAPDESC
-                        pSucc = (HEAPDESC*)((PBYTE)&pThis[1] + size);
+                if (NULL != pSlot)
+                    return pSlot;
+            }
 
-                        pThis->qwMagic = ALLOCMEM;
-                        pSucc->qwMagic = FREEMEM;
+            if (size >= CDE_HEAP_LARGE_MIN && FALSE == fPool && NULL == __heapBinFind(pCtrl, NULL, size))    // NOTE: large free blocks stem from inalterable pages
+                return __largeAlloc(pCdeAppIf, pCtrl, size, CDE_HEAP_ALIGN);
 
-                        pSucc->pSucc = pThis->pSucc;    //1
-                        pSucc->pSucc->pPred = pSucc;    //2
-                        pSucc->pPred = pThis;           //3
-                        pThis->pSucc = pSucc;           //4
+            pThis = __heapAlloc(pCdeAppIf, pCtrl, size, CDE_HEAP_ALIGN, pHeapStart);
+        }//if(ptr != NULL)
+    } while (0);
 
-                        break;
-                    }
-                }
+    return pThis == NULL ? NULL : pThis + 1;
+}
+
+/** _cdeMemAlignedRealloc()
+
+Synopsis
+
+    void* _cdeMemAlignedRealloc(
+        CDE_APP_IF* pCdeAppIf,
+        void* ptr,
+        size_t size,
+        size_t alignment,
+        HEAPDESC* pHeapStart
+    )
 
-                if (NULL == pThis->pSucc) {
+Description
 
-                    unsigned long long qwPages = ((size + 3 * HDX) % PAGESIZE) ? (unsigned long long)((size + 3 * HDX) / PAGESIZE) + 1 : (unsigned long long)((size + 3 * HDX) / PAGESIZE) + 0;
-                    HEAPDESC* pTmpThis, * pTmpSucc, * pTmpEnd;
-                    HEAPDESC* pPageBase;		//	W/A
+    Toro C Library common memory suballocator, aligned allocation
 
-                    pPageBase = qwPages >= CDE_MEMALLOC_PAGES_MAX ? NULL : pCdeAppIf->pCdeServices->pMemAlloc(pCdeAppIf, (unsigned int)qwPages);
-                    if (pPageBase) {
+    Same as _cdeMemRealloc(), but the memory block is aligned to alignment,
+    that is a power of two. Blocks are released by _cdeMemRealloc() with size 0.
 
-                        pThis->pSucc = (HEAPDESC*)pPageBase;
-                        pTmpThis = pThis->pSucc;                                                        // use tmp temporarily
+    The leading slack of a HEAPDESC block is split off into a FREEMEM block.
+    Blocks of CDE_HEAP_LARGE_MIN bytes and above, or aligned to PAGESIZE and above,
+    get page runs of their own.
 
-                        pTmpEnd = (HEAPDESC*)((PBYTE)&pTmpThis[0] + (qwPages * PAGESIZE) - HDX);
+    An aligned block, that holds size bytes, is not moved nor shrunk.
 
-                        pTmpSucc = (HEAPDESC*)((PBYTE)&pTmpThis[1] + size);
+Returns
 
-                        pTmpThis->qwMagic = FREEMEM;                                                    //set to ALLOCMEM during next turn
-                        pTmpSucc->qwMagic = FREEMEM;
-                        pTmpEnd->qwMagic = ENDOFMEM;
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[in] void* ptr
+    @param[in] size_t size
+    @param[in] size_t alignment
+    @param[in] HEAPDESC * pHeapStart
 
-                        pTmpThis->PageBase = (EFI_PHYSICAL_ADDRESS)pPageBase;
-                        pTmpThis->Pages = (unsigned int)qwPages;
+    @retval void * memory block
+            NULL on FAIL, alignment is not a power of two
+
+**/
+void* _cdeMemAlignedRealloc(
+    CDE_APP_IF* pCdeAppIf,
+    IN void* ptr,
+    IN size_t size,
+    IN size_t alignment,
+    HEAPDESC* pHeapStart
+)
+{
+    return __heapEntry(pCdeAppIf, _ReturnAddress(), ptr, size, TRUE, alignment, pHeapStart);
+}
+
+/** __cdeMemAlignedRealloc() - _cdeMemAlignedRealloc() without running counters and profiling
+**/
+static void* __cdeMemAlignedRealloc(
+    CDE_APP_IF* pCdeAppIf,
+    IN void* ptr,
+    IN size_t size,
+    IN size_t alignment,
+    HEAPDESC* pHeapStart
+)
+{
+    HEAPCTRL* pCtrl = &pCdeAppIf->pCdeServices->HeapCtrl;
+    HEAPDESC* pThis;
+    SLABDESC* pSlab;
+    TINYHDR* pHdr;
+    void* pRet = NULL;
+    size_t nCap = 0;
+
+    do {
+
+        if (0 == alignment || 0 != (alignment & (alignment - 1)) || alignment > CDE_MEMALLOC_PAGES_MAX / 2 * (size_t)PAGESIZE)
+            break;
+
+        if (alignment <= CDE_HEAP_ALIGN || (NULL != ptr && 0 == size))
+            return __cdeMemRealloc(pCdeAppIf, ptr, size, pHeapStart);
+
+        __heapRestart(pCdeAppIf, pHeapStart);
+        pCtrl->pKnownZero = NULL;
+        ptr = __tinyMigrated(pCtrl, ptr);
+
+        if (size > ~(size_t)0 - 4 * PAGESIZE - alignment)           // prevent overflow of size calculations
+            break;
+
+        size = size == 0 ? CDE_HEAP_ALIGN : (size + CDE_HEAP_ALIGN - 1) & ~((size_t)CDE_HEAP_ALIGN - 1);
+
+        if (NULL != ptr) {
+
+            if (NULL != pCtrl->pTiny && NULL != (pHdr = __tinyOf(pCtrl, ptr)))
+                nCap = TINYSIZE(pHdr) - sizeof(TINYHDR);
+            else if (NULL != (pSlab = __slabOf(ptr)))
+                nCap = pSlab->wSlotSize;
+            else if (NULL != (pThis = __largeOf(ptr)))
+                nCap = (size_t)(pThis->PageBase + (unsigned long long)pThis->Pages * PAGESIZE - (size_t)ptr);
+            else if (ALLOCMEM == (pThis = &((HEAPDESC*)ptr)[-1])->qwMagic)
+                nCap = BLKSIZE(pThis);
+            else
+                break;                                              // not own memory
+
+            if (0 == ((size_t)ptr & (alignment - 1)) && size <= nCap) {
+                pRet = ptr;
+                break;
+            }
+        }
+
+        if (FALSE != pCtrl->fTinyHeap)                              // Pre-Memory-PEI
+            pRet = __tinyAlignedAlloc(pCdeAppIf, pCtrl, size, alignment);
+        else if (NULL == __heapPoolOwned(pCdeAppIf, pCtrl) && (size >= CDE_HEAP_LARGE_MIN || alignment >= PAGESIZE))
+            pRet = __largeAlloc(pCdeAppIf, pCtrl, size, alignment);
+        else {
+            pThis = __heapAlloc(pCdeAppIf, pCtrl, size, alignment, pHeapStart);
+            pRet = NULL == pThis ? NULL : &pThis[1];
+        }
+
+        if (NULL != ptr && NULL != pRet) {
+            __heapCopy(pRet, ptr, size < nCap ? size : nCap);
+            __cdeMemRealloc(pCdeAppIf, ptr, 0, pHeapStart);
+        }
 
-                        pTmpThis->pPred = pThis;
-                        pTmpThis->pSucc = pTmpSucc;
-                        pTmpSucc->pPred = pTmpThis;
-                        pTmpSucc->pSucc = pTmpEnd;
-                        pTmpEnd->pPred = pTmpSucc;
-                        pTmpEnd->pSucc = NULL;
-                    }
-                }
-                pThis = pThis->pSucc;
-            } while (pThis != NULL);
-        }//if(ptr != NULL)
     } while (0);
 
-    return pThis == NULL ? NULL : pThis + 1;
-}
\ No newline at end of file
+    return pRet;
+}
+
+/** _cdeHeapPoolCreate()
+
+Synopsis
+
+    int _cdeHeapPoolCreate(
+        CDE_APP_IF* pCdeAppIf,
+        unsigned long Pages,
+        HEAPDESC* pHeapStart
+    )
+
+Description
+
+    Reserve a fixed pool of Pages pages for the memory suballocator, owned by the driver
+    of pCdeAppIf.
+
+    The pool is taken from pMemAlloc() at once, along with the HEAPPOOL control structure,
+    and linked into the HEAPDESC chain as an inalterable page run, that is kept when emptied.
+    Subsequently all memory blocks of the driver are taken from the pool, in bounded time and
+    without further pMemAlloc() calls. Other drivers of the shared CDE_SERVICES (SMM) are not
+    affected, they don't take blocks from the pool.
+    Blocks allocated before remain valid.
+
+    Invoked at SMM driver entry, if _gCdeCfgSmmPoolPages is nonzero.
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[in] unsigned long Pages
+    @param[in] HEAPDESC* pHeapStart
+
+    @retval 0 on success, or if the driver reserved the fixed pool already
+            -1 on FAIL
+
+**/
+int _cdeHeapPoolCreate(
+    CDE_APP_IF* pCdeAppIf,
+    IN unsigned long Pages,
+    IN HEAPDESC* pHeapStart
+)
+{
+    HEAPCTRL* pCtrl = &pCdeAppIf->pCdeServices->HeapCtrl;
+    unsigned long PoolPages = (unsigned long)((sizeof(HEAPPOOL) + PAGESIZE - 1) / PAGESIZE);
+    HEAPDESC* pPageBase;
+    HEAPPOOL* pPool;
+    size_t i;
+    int nRet = -1;
+
+    do {
+
+        if (!CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices))
+            break;                                                  // CDE_SERVICES without HEAPCTRL
+
+        __heapRestart(pCdeAppIf, pHeapStart);
+
+        if (NULL != __heapPoolOwned(pCdeAppIf, pCtrl)) {
+            nRet = 0;                                               // reserved already
+            break;
+        }
+
+        if (0 == Pages || Pages >= CDE_MEMALLOC_PAGES_MAX - PoolPages)
+            break;
+
+        pPool = pCdeAppIf->pCdeServices->pMemAlloc(pCdeAppIf, (unsigned int)(PoolPages + Pages));
+        if (NULL == pPool)
+            break;
+
+        pCtrl->Count.qwPagesAlloc += PoolPages + Pages;
+
+        for (i = 0; i < sizeof(HEAPPOOL); i++)
+            ((PBYTE)pPool)[i] = 0;
+
+        pPageBase = (HEAPDESC*)((PBYTE)pPool + (size_t)PoolPages * PAGESIZE);
+
+        pPool->pOwner = pCdeAppIf;
+        pPool->pBase = (PBYTE)pPageBase;
+        pPool->pEnd = (PBYTE)pPageBase + (size_t)Pages * PAGESIZE;
+        pPool->pSucc = pCtrl->pPool;
+        pCtrl->pPool = pPool;                                       // register before linking the page run
+
+        __heapRunLink(pCtrl, pHeapStart, pPageBase, Pages);
+
+        pPageBase->fInalterable = TRUE;                             // keep the pool when emptied
+        pCtrl->pZeroBase = pCtrl->pZeroEnd = NULL;
+        nRet = 0;
+
+    } while (0);
+
+    return nRet;
+}
+
+/** _cdeHeapRestart()
+
+Synopsis
+
+    void _cdeHeapRestart(
+        CDE_APP_IF* pCdeAppIf,
+        HEAPDESC* pHeapStart
+    )
+
+Description
+
+    Restart memory allocation if switched from Pre-Memory-PEI to Post-Memory-PEI,
+    re-register a migrated compact heap. Invoked on exit by _cdeMemRelease().
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[in] HEAPDESC* pHeapStart
+
+    @retval void
+
+**/
+void _cdeHeapRestart(
+    CDE_APP_IF* pCdeAppIf,
+    IN HEAPDESC* pHeapStart
+)
+{
+    if (CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices))
+        __heapRestart(pCdeAppIf, pHeapStart);
+}
+
+/** _cdeHeapStats()
+
+Synopsis
+
+    int _cdeHeapStats(
+        CDE_APP_IF* pCdeAppIf,
+        CDEHEAPSTATS* pStats,
+        HEAPWALK* pfnWalk,
+        void* pContext
+    )
+
+Description
+
+    Gather heap statistics and/or walk all memory blocks.
+
+    The HEAPDESC chain, the slab pages, the LARGEMEM list, the compact heap and the
+    page cache are visited. pfnWalk, if not NULL, is invoked with pContext for each
+    ALLOCMEM and FREEMEM block of the HEAPDESC chain, each allocated slab slot (SLABMEM),
+    each LARGEMEM block and each compact heap block (TINYMEM or FREEMEM).
+    The running counters are copied from HEAPCTRL.
+
+    The heap must not be modified by pfnWalk.
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[out] CDEHEAPSTATS* pStats, optional
+    @param[in] HEAPWALK* pfnWalk, optional
+    @param[in] void* pContext
+
+    @retval 0 walk completed
+            nonzero return value of pfnWalk, that stopped the walk
+            -1 if the CDE_SERVICES do not provide HEAPCTRL
+
+**/
+int _cdeHeapStats(
+    CDE_APP_IF* pCdeAppIf,
+    OUT CDEHEAPSTATS* pStats,
+    IN HEAPWALK* pfnWalk,
+    IN void* pContext
+)
+{
+    HEAPCTRL* pCtrl = &pCdeAppIf->pCdeServices->HeapCtrl;
+    HEAPDESC* pHeapStart = &pCdeAppIf->pCdeServices->HeapStart;
+    CDEHEAPSTATS Stats = { 0 };
+    HEAPDESC* pThis;
+    SLABDESC* pSlab;
+    TINYDESC* pTiny;
+    TINYHDR* pHdr;
+    size_t size;
+    unsigned i, j, k;
+    int nRet = 0;
+
+    if (!CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices))
+        return -1;                                                  // CDE_SERVICES without HEAPCTRL
+
+    __heapRestart(pCdeAppIf, pHeapStart);
+
+    //
+    // HEAPDESC chain
+    //
+    for (pThis = pHeapStart->pSucc; NULL != pThis && 0 == nRet; pThis = pThis->pSucc) {
+
+        if (ENDOFMEM == pThis->qwMagic) {
+            Stats.Runs++;
+            Stats.RunPages += pThis->Pages;
+            continue;
+        }
+
+        size = BLKSIZE(pThis);
+
+        if (FREEMEM == pThis->qwMagic) {
+            Stats.FreeBlocks++;
+            Stats.FreeBytes += size;
+            if (size > Stats.LargestFree)
+                Stats.LargestFree = size;
+        }
+        else {
+            Stats.BlocksInUse++;
+            Stats.BytesInUse += size;
+        }
+
+        if (NULL != pfnWalk)
+            nRet = pfnWalk(pContext, &pThis[1], size, pThis->qwMagic);
+    }
+
+    //
+    // slab pages
+    //
+    for (i = 0; i < CDE_SLAB_CLASSES && 0 == nRet; i++) {
+        for (j = 0; j < 2 && 0 == nRet; j++) {
+
+            pSlab = j == 0 ? pCtrl->rgpSlab[i] : pCtrl->rgpSlabFull[i];
+
+            for (/* pSlab */; NULL != pSlab && 0 == nRet; pSlab = pSlab->pSucc) {
+
+                Stats.SlabPages++;
+                Stats.SlabSlotsFree += pSlab->nFree;
+                Stats.BlocksInUse += (size_t)pSlab->nSlots - pSlab->nFree;
+                Stats.BytesInUse += ((size_t)pSlab->nSlots - pSlab->nFree) * pSlab->wSlotSize;
+
+                if (NULL == pfnWalk)
+                    continue;
+
+                for (k = 0; k < pSlab->nSlots && 0 == nRet; k++)
+                    if (0 == (pSlab->bmFree[k / 64] & (1ULL << (k % 64))))
+                        nRet = pfnWalk(pContext, (PBYTE)pSlab + SLABHDX + k * (size_t)pSlab->wSlotSize, pSlab->wSlotSize, SLABMEM);
+            }
+        }
+    }
+
+    //
+    // LARGEMEM blocks
+    //
+    for (pThis = pCtrl->pLarge; NULL != pThis && 0 == nRet; pThis = pThis->pSucc) {
+
+        size = (size_t)(pThis->PageBase + (unsigned long long)pThis->Pages * PAGESIZE - (size_t)&pThis[1]);
+
+        Stats.LargeBlocks++;
+        Stats.LargePages += pThis->Pages;
+        Stats.BlocksInUse++;
+        Stats.BytesInUse += size;
+
+        if (NULL != pfnWalk)
+            nRet = pfnWalk(pContext, &pThis[1], size, LARGEMEM);
+    }
+
+    //
+    // compact heap
+    //
+    for (pTiny = pCtrl->pTiny; NULL != pTiny && 0 == nRet; pTiny = pTiny->pSucc) {
+
+        Stats.TinyPages += pTiny->Pages;
+
+        for (pHdr = (TINYHDR*)((PBYTE)pTiny + TINYHDX); 0 != TINYSIZE(pHdr) && 0 == nRet; pHdr = TINYNEXT(pHdr)) {
+
+            size = TINYSIZE(pHdr) - sizeof(TINYHDR);
+
+            if (0 != (pHdr->cbSize & 1)) {
+                Stats.BlocksInUse++;
+                Stats.BytesInUse += size;
+            }
+            else {
+                Stats.FreeBlocks++;
+                Stats.FreeBytes += size;
+                if (size > Stats.LargestFree)
+                    Stats.LargestFree = size;
+            }
+
+            if (NULL != pfnWalk)
+                nRet = pfnWalk(pContext, &pHdr[1], size, 0 != (pHdr->cbSize & 1) ? TINYMEM : FREEMEM);
+        }
+    }
+
+    Stats.CachePages = (size_t)pCtrl->qwPageCachePages;
+    Stats.Count = pCtrl->Count;
+
+    if (NULL != pStats)
+        *pStats = Stats;
+
+    return nRet;
+}
@@ -0,0 +1,236 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    _cdeMemRelease.c
+
+Abstract:
+
+    Toro C Library release memory of the common memory suballocator on exit
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+
+#define PAGESIZE 4096
+
+typedef unsigned long long EFI_PHYSICAL_ADDRESS;
+
+extern ARENADESTROY _cdeArenaDestroy;
+extern HEAPPROFSTOP _cdeHeapProfStop;
+extern HEAPRESTART _cdeHeapRestart;
+
+/** _cdeMemRelease()
+
+Synopsis
+
+    void _cdeMemRelease(
+        CDE_APP_IF* pCdeAppIf,
+        HEAPDESC* pHeapStart
+    )
+
+Description
+
+    Release all memory allocated during runtime.
+
+    The heap profiler is stopped.
+    Slab pages are returned to the OSIF. Inalterable slab pages (PEI) can not be
+    returned, they are marked empty and kept for reuse.
+    Remaining arenas are destroyed and LARGEMEM blocks are freed.
+    Compact heap regions are returned to the OSIF, inalterable ones (Pre-Memory-PEI)
+    are reset to a single free block and kept.
+    The page runs of the HEAPDESC chain are released directly from the page run list,
+    so the time taken depends on the number of pages, not on the number of memory blocks.
+    Fixed pools (SMM) are inalterable and kept as a single free block.
+    Finally the page cache is handed back to the OSIF.
+
+    CDE_SERVICES without HEAPCTRL, provided by an earlier CdeServices driver, are
+    released block by block.
+
+Returns
+
+    @param[in] CDE_APP_IF* pCdeAppIf
+    @param[in] HEAPDESC * pHeapStart
+
+    @retval void
+
+**/
+void _cdeMemRelease(
+    CDE_APP_IF* pCdeAppIf,
+    IN HEAPDESC* pHeapStart
+)
+{
+    HEAPCTRL* pCtrl = &pCdeAppIf->pCdeServices->HeapCtrl;
+    HEAPDESC* pHeap, * pHeapSucc, * pRun, * pRunSucc;
+    SLABDESC* pSlab, * pSucc, * pKeep;
+    TINYDESC* pTiny, * pTinySucc, * pTinyKeep = NULL;
+    TINYHDR* pHdr, * pEnd;
+    HEAPPOOL* pPool;
+    int i, j;
+    unsigned k;
+
+    //
+    // CDE_SERVICES without HEAPCTRL: free the memory blocks one by one
+    //
+    if (!CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices)) {
+        pHeap = pHeapStart;
+        do {
+            if (ALLOCMEM == pHeap->qwMagic) {
+                pCdeAppIf->pCdeServices->pMemRealloc(pCdeAppIf, &pHeap[1], 0, pHeapStart);
+                pHeap = pHeapStart;
+            }
+            pHeap = pHeap->pSucc;
+        } while (NULL != pHeap);
+        return;
+    }
+
+    //
+    // stop the heap profiler, re-register a migrated compact heap
+    //
+    _cdeHeapProfStop(pCdeAppIf);
+    _cdeHeapRestart(pCdeAppIf, pHeapStart);
+
+    //
+    // release slab pages
+    //
+    for (i = 0; i < CDE_SLAB_CLASSES; i++) {
+
+        pKeep = NULL;
+
+        for (j = 0; j < 2; j++) {
+
+            pSlab = j == 0 ? pCtrl->rgpSlab[i] : pCtrl->rgpSlabFull[i];
+
+            for (/* pSlab */; NULL != pSlab; pSlab = pSucc) {
+
+                pSucc = pSlab->pSucc;
+
+                if (FALSE == pSlab->fInalterable) {
+                    pSlab->qwMagic = FREEMEM;
+                    pCdeAppIf->pCdeServices->pMemFree(pCdeAppIf, (EFI_PHYSICAL_ADDRESS)pSlab, 1);
+                    continue;
+                }
+
+                pSlab->nFree = pSlab->nSlots;
+                for (k = 0; k < sizeof(pSlab->bmFree) / sizeof(pSlab->bmFree[0]); k++)
+                    pSlab->bmFree[k] = 0ULL;
+                for (k = 0; k < pSlab->nSlots; k++)
+                    pSlab->bmFree[k / 64] |= 1ULL << (k % 64);
+                pSlab->pPred = NULL;
+                pSlab->pSucc = pKeep;
+                if (NULL != pKeep)
+                    pKeep->pPred = pSlab;
+                pKeep = pSlab;
+            }
+        }
+
+        pCtrl->rgpSlab[i] = pKeep;
+        pCtrl->rgpSlabFull[i] = NULL;
+    }
+
+    //
+    // destroy arenas
+    //
+    while (NULL != pCtrl->pArena)
+        _cdeArenaDestroy(pCdeAppIf, pCtrl->pArena);
+
+    //
+    // free LARGEMEM blocks
+    //
+    while (NULL != pCtrl->pLarge)
+        pCdeAppIf->pCdeServices->pMemRealloc(pCdeAppIf, &pCtrl->pLarge[1], 0, pHeapStart);
+
+    //
+    // release the compact heap regions
+    //
+    for (pTiny = pCtrl->pTiny; NULL != pTiny; pTiny = pTinySucc) {
+
+        pTinySucc = pTiny->pSucc;
+
+        if (FALSE == pTiny->fInalterable) {
+            pTiny->qwMagic = FREEMEM;
+            pCdeAppIf->pCdeServices->pMemFree(pCdeAppIf, (EFI_PHYSICAL_ADDRESS)pTiny, pTiny->Pages);
+            continue;
+        }
+
+        pHdr = (TINYHDR*)((unsigned char*)pTiny + ((sizeof(TINYDESC) + CDE_TINY_ALIGN - 1) & ~(CDE_TINY_ALIGN - 1)));
+        pEnd = (TINYHDR*)((unsigned char*)pTiny + (size_t)pTiny->Pages * PAGESIZE - sizeof(TINYHDR));
+        pHdr->cbSize = (unsigned char*)pEnd - (unsigned char*)pHdr;
+        pHdr->cbPrev = 0;
+        pEnd->cbPrev = pHdr->cbSize;
+
+        pTiny->pSucc = pTinyKeep;
+        pTinyKeep = pTiny;
+    }
+
+    pCtrl->pTiny = pTinyKeep;
+    if (NULL == pTinyKeep)
+        pCtrl->pTinyBase = pCtrl->pTinyEnd = NULL;
+
+    //
+    // release the page runs of the HEAPDESC chain, without visiting the memory blocks.
+    // Inalterable page runs (PEI) are relinked as a single free memory block.
+    //
+    pRun = pCtrl->pRun;
+
+    pHeapStart->pSucc = NULL;
+    pCtrl->pRun = NULL;
+    pCtrl->pZeroBase = pCtrl->pZeroEnd = NULL;
+    for (k = 0; k < CDE_HEAP_BINS; k++)
+        pCtrl->rgpBin[k] = NULL;
+    for (k = 0; k < CDE_HEAP_BINS / 64; k++)
+        pCtrl->bmBins[k] = 0ULL;
+    for (pPool = pCtrl->pPool; NULL != pPool; pPool = pPool->pSucc) {
+        for (k = 0; k < CDE_HEAP_BINS; k++)
+            pPool->rgpBin[k] = NULL;
+        for (k = 0; k < CDE_HEAP_BINS / 64; k++)
+            pPool->bmBins[k] = 0ULL;
+    }
+
+    for (/* pRun */; NULL != pRun; pRun = pRunSucc) {
+
+        pRunSucc = (HEAPDESC*)pRun->CrumbleFront;
+        pHeap = (HEAPDESC*)pRun->PageBase;
+
+        if (FALSE == pHeap->fInalterable) {
+            pCdeAppIf->pCdeServices->pMemFree(pCdeAppIf, pRun->PageBase, (unsigned int)pRun->Pages);
+            continue;
+        }
+
+        pRun->CrumbleRear = NULL;                                   // register the page run again
+        pRun->CrumbleFront = pCtrl->pRun;
+        if (NULL != pCtrl->pRun)
+            pCtrl->pRun->CrumbleRear = pRun;
+        pCtrl->pRun = pRun;
+
+        pRun->pSucc = pHeapStart->pSucc;                            // link in front of the HEAPDESC chain
+        if (NULL != pRun->pSucc)
+            pRun->pSucc->pPred = pRun;
+        pRun->pPred = pHeap;
+        pHeap->pSucc = pRun;
+        pHeap->pPred = pHeapStart;
+        pHeapStart->pSucc = pHeap;
+
+        pHeap->qwMagic = ALLOCMEM;                                  // free() inserts it into its size class list
+        pCdeAppIf->pCdeServices->pMemRealloc(pCdeAppIf, &pHeap[1], 0, pHeapStart);
+    }
+
+    //
+    // hand back the page cache
+    //
+    for (pHeap = pCtrl->pPageCache; NULL != pHeap; pHeap = pHeapSucc) {
+        pHeapSucc = pHeap->pSucc;
+        pCdeAppIf->pCdeServices->pMemFree(pCdeAppIf, pHeap->PageBase, (unsigned int)pHeap->Pages);
+    }
+    pCtrl->pPageCache = NULL;
+    pCtrl->qwPageCachePages = 0;
+}
@@ -14,6 +14,12 @@ Abstract:
 
     CDE internal worker function for all mem/str/wcs-compare functions
 
+    _cdeMemStrxCmp() is the dispatcher, provided through CDE_SERVICES.
+    The ROMPARM is decoded once per call, to select one of the variants below,
+    specialized for fWide, fCaseSensitive and fBreakOnZero at build time.
+    Equal elements are skipped by the SSE2/SWAR mismatch kernels, case
+    insensitive variants fold the mismatching characters through a table.
+
 Author:
 
     Kilian Kegel
@@ -21,42 +27,92 @@ Author:
 --*/
 #include <CdeServices.h>
 
-extern short ydes(unsigned char fDes, signed i, short v);
-
-signed _cdeMemStrxCmp(IN ROMPARM_MEMSTRXCMP* pFixParm, IN const char* pszDest, IN const char* pszSource, IN size_t count) {
-    unsigned char fDes = 2 == (pFixParm->fForceToDataSeg & 2);
-    register signed n = 0;
-    wchar_t c1, c2;
-    size_t  wCnt = (size_t)-1;
-    unsigned char bORVal = ((!pFixParm->fCaseSensitive) << 5);  //ORVal is ORed to
-                                                        //to ASCII A..Z, a..z
-                                                        //it is 0x20 fCaseSensitive
-                                                        // 0x00 otherwise
-                                                        // patent pendig
-
-    pszDest = pFixParm->fWide ? (/*const*/ char*)&(((wchar_t*)pszDest)[-1]) : &pszDest[-1];
-    pszSource = pFixParm->fWide ? (/*const*/ char*)&(((wchar_t*)pszSource)[-1]) : &pszSource[-1];
-
-    do {
-
-        if (++wCnt == count)         // TODO: test 0 count
-            break;                  // TODO: test 0 count
-
-        pszDest = pFixParm->fWide ? (/*const*/ char*)&(((wchar_t*)pszDest)[1]) : &pszDest[1];
-        pszSource = pFixParm->fWide ? (/*const*/ char*)&(((wchar_t*)pszSource)[1]) : &pszSource[1];
-
-        c1 = pFixParm->fWide ? *((wchar_t*)pszDest) : *pszDest;
-        c2 = pFixParm->fWide ? *((wchar_t*)pszSource) : *pszSource;
-        c2 = ydes(fDes, (signed)wCnt, c2);
-        c1 = ((c1 <= 'Z') && (c1 >= 'A')) ? c1 |= bORVal : c1;
-        c2 = ((c2 <= 'Z') && (c2 >= 'A')) ? c2 |= bORVal : c2;
-
-        n = c1 - c2;
-
+typedef int MEMSTRXCMPVARIANT(const void* pszDest, const void* pszSource, size_t count);
+
+extern size_t __cdeMemMismatch(const void* s1, const void* s2, size_t n, int fWide);
+extern size_t __cdeStrMismatch(const void* s1, const void* s2, size_t n, int fWide);
+
+//
+// case fold table, ASCII A..Z to a..z
+//
+static const unsigned char __cdeFold[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+    0x40, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
+    0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+    0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,
+    0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
+    0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F,
+    0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+    0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+    0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+    0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+    0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
+};
+
+#define CASE(c) (c)
+#define NOCASE(c) ((c) < 256 ? __cdeFold[c] : (c))
+
+//
+// MEMSTRXCMP_VARIANT(name, type, fold, fBreakOnZero) - compare loop with the preset resolved
+//
+//  The mismatch kernels skip the equal elements, characters are folded at a
+//  mismatch only.
+//
+#define MEMSTRXCMP_VARIANT(name, T, FOLD, fBoz)                     \
+static int name(const void* pszDest, const void* pszSource, size_t count) {\
+    const T* p1 = pszDest;                                          \
+    const T* p2 = pszSource;                                        \
+    int fWide = sizeof(T) > 1;                                      \
+    size_t i = 0;                                                   \
+    int c1, c2;                                                     \
+                                                                    \
+    while (i < count) {                                             \
+        if (fBoz)                                                   \
+            i += __cdeStrMismatch(&p1[i], &p2[i], count - i, fWide);\
+        else                                                        \
+            i += __cdeMemMismatch(&p1[i], &p2[i], count - i, fWide);\
+        if (i == count)                                             \
+            break;                                                  \
+        c1 = p1[i];                                                 \
+        c2 = p2[i];                                                 \
+        c1 = FOLD(c1);                                              \
+        c2 = FOLD(c2);                                              \
+        if (c1 != c2)                                               \
+            return c1 - c2;                                         \
+        if (fBoz && '\0' == c1)                                      \
+            break;                                                  \
+        i++;                                                        \
+    }                                                               \
+    return 0;                                                       \
+}
 
-        c1 = pFixParm->fBreakOnZero ? c1 : -1;
+MEMSTRXCMP_VARIANT(__memCmp8,     unsigned char,  CASE,   0)        // memcmp()
+MEMSTRXCMP_VARIANT(__memCmp16,    unsigned short, CASE,   0)        // wmemcmp()
+MEMSTRXCMP_VARIANT(__memICmp8,    unsigned char,  NOCASE, 0)
+MEMSTRXCMP_VARIANT(__memICmp16,   unsigned short, NOCASE, 0)
+MEMSTRXCMP_VARIANT(__strCmp8,     unsigned char,  CASE,   1)        // strcmp(), strncmp()
+MEMSTRXCMP_VARIANT(__strCmp16,    unsigned short, CASE,   1)        // wcscmp(), wcsncmp()
+MEMSTRXCMP_VARIANT(__strICmp8,    unsigned char,  NOCASE, 1)        // _stricmp(), _strnicmp()
+MEMSTRXCMP_VARIANT(__strICmp16,   unsigned short, NOCASE, 1)        // _wcsicmp(), _wcsnicmp()
 
-    } while (n == 0 && c1 != 0);
+signed _cdeMemStrxCmp(IN ROMPARM_MEMSTRXCMP* pFixParm, IN const char* pszDest, IN const char* pszSource, IN size_t count) {
+    static MEMSTRXCMPVARIANT* const rgVariant[8] = {
+        /*             */ __memICmp8,
+        /* WID         */ __memICmp16,
+        /* CAS         */ __memCmp8,
+        /* CAS WID     */ __memCmp16,
+        /* BOZ         */ __strICmp8,
+        /* BOZ WID     */ __strICmp16,
+        /* BOZ CAS     */ __strCmp8,
+        /* BOZ CAS WID */ __strCmp16,
+    };
+    int idx = (pFixParm->fWide ? 1 : 0) + (pFixParm->fCaseSensitive ? 2 : 0) + (pFixParm->fBreakOnZero ? 4 : 0);
+    signed n = rgVariant[idx](pszDest, pszSource, count);
 
     if (pFixParm->fAjustDifference) {
         n = n < 0 ? -1 : (n > 0 ? 1 : n);     /*MS compatibility: return -1,0,1 only on non-"n" types*/
@@ -14,6 +14,14 @@ Abstract:
 
     CDE internal worker function for all mem/str/wcs-copy functions
 
+    _cdeMemStrxCpy() is the dispatcher, provided through CDE_SERVICES.
+    The preset is decoded once per call, to select one of the variants below,
+    specialized for WID, BOZ and TDN at build time:
+
+        memmove()/wmemmove()        __memMoveUp(), __memMoveDn()
+        strcpy()/strncpy()          __strCpy8()
+        wcscpy()/wcsncpy()          __strCpy16()
+
 Author:
 
     Kilian Kegel
@@ -21,45 +29,118 @@ Author:
 --*/
 #include <CdeServices.h>
 
-void* _cdeMemStrxCpy(IN int preset, OUT void* pszDest, IN const void* pszSource, IN  size_t count) //,IN unsigned char fBreakOnZero/* distinguish mem- vs. strcpy */,IN unsigned char fWide)
-{
-    unsigned n;
-    signed xcrement = PRESET_TDN ? -1 : 1;//increment vs decrement
-    unsigned short 	c;
+extern void* __cdeMemCpyFwd(void* pDst, const void* pSrc, size_t n);
+extern void* __cdeMemCpyBwd(void* pDst, const void* pSrc, size_t n);
+extern void* __cdeMemFill(void* pDst, unsigned long long qwFill, size_t n);
+extern void* __cdeMemChr(const void* s, int c, size_t n);
+extern void* __cdeWMemChr(const unsigned short* s, unsigned short c, size_t n);
+extern size_t __cdeWcsLen(const unsigned short* pwcsStr);
+
+typedef void* MEMSTRXCPYVARIANT(void* pszDest, const void* pszSource, size_t count, size_t nElem);
+
+/** __memMoveUp() - memmove()/wmemmove(), from lower to higher addresses
+**/
+static void* __memMoveUp(void* pszDest, const void* pszSource, size_t count, size_t nElem) {
+
+    __cdeMemCpyFwd(pszDest, pszSource, count * nElem);
+
+    return pszDest;
+}
+
+/** __memMoveDn() - memmove()/wmemmove(), from higher to lower addresses
+
+    TDN passes the last element.
+**/
+static void* __memMoveDn(void* pszDest, const void* pszSource, size_t count, size_t nElem) {
+
+    if (0 != count)
+        __cdeMemCpyBwd((unsigned char*)pszDest - (count - 1) * nElem, (const unsigned char*)pszSource - (count - 1) * nElem, count * nElem);
+
+    return pszDest;
+}
+
+/** __strCpyFill() - copy nCopy elements, fill the remaining buffer up to count with '\0'
+
+    strncpy()/wcsncpy() support, count (size_t)-1 is strcpy()/wcscpy()
+**/
+static void* __strCpyFill(void* pszDest, const void* pszSource, size_t count, size_t nCopy, size_t nElem) {
+
+    __cdeMemCpyFwd(pszDest, pszSource, nCopy * nElem);
+
+    if ((size_t)-1 != count && count > nCopy)
+        __cdeMemFill((unsigned char*)pszDest + nCopy * nElem, 0, (count - nCopy) * nElem);
+
+    return pszDest;
+}
+
+/** __strCpy8() - strcpy()/strncpy()
+**/
+static void* __strCpy8(void* pszDest, const void* pszSource, size_t count, size_t nElem) {
+    const char* pEnd = __cdeMemChr(pszSource, '\0', count);
+    size_t nCopy = NULL == pEnd ? count : (size_t)(pEnd - (const char*)pszSource) + 1;
+
+    return __strCpyFill(pszDest, pszSource, count, nCopy, nElem);
+}
+
+/** __strCpy16() - wcscpy()/wcsncpy()
+**/
+static void* __strCpy16(void* pszDest, const void* pszSource, size_t count, size_t nElem) {
+    const unsigned short* pEnd;
+    size_t nCopy;
+
+    if (count > (size_t)-1 / sizeof(unsigned short))
+        nCopy = __cdeWcsLen(pszSource) + 1;
+    else {
+        pEnd = __cdeWMemChr(pszSource, '\0', count);
+        nCopy = NULL == pEnd ? count : (size_t)(pEnd - (const unsigned short*)pszSource) + 1;
+    }
+
+    return __strCpyFill(pszDest, pszSource, count, nCopy, nElem);
+}
+
+/** __strCpyDn() - BOZ + TDN, not used by the library, character by character
+**/
+static void* __strCpyDn(void* pszDest, const void* pszSource, size_t count, size_t nElem) {
     unsigned char* pDst8 = pszDest;
-    unsigned short* pDst16 = pszDest;
     const unsigned char* pSrc8 = pszSource;
+    unsigned short* pDst16 = pszDest;
     const unsigned short* pSrc16 = pszSource;
+    size_t n;
 
-    for (n = 0; n < count; n++, pDst8 = &pDst8[xcrement], pSrc8 = &pSrc8[xcrement], pDst16 = &pDst16[xcrement], pSrc16 = &pSrc16[xcrement])
-    {
-
-        if (PRESET_WID) {
-            *pDst16 = *pSrc16;
-            c = *pSrc16;
+    for (n = 0; n < count; n++) {
+        if (sizeof(unsigned short) == nElem) {
+            if ('\0' == (*pDst16-- = *pSrc16--))
+                break;
         }
         else {
-            *pDst8 = *pSrc8;
-            c = (unsigned short)*pSrc8;
+            if ('\0' == (*pDst8-- = *pSrc8--))
+                break;
         }
-
-        if ((PRESET_BOZ) && c == '\0')
-            break;
     }
-    //
-    // strncpy support -- that fills remaining buffer until count
-    //
-    if ((-1 != count) && PRESET_BOZ) {
-        for ( /*n = 0*/; n < count; n++, pDst16 = &pDst16[xcrement], pDst8 = &pDst8[xcrement]) {
-
-            if (PRESET_WID) {
-                *pDst16 = '\0';
-            }
-            else {
-                *pDst8 = '\0';
-            }
-        }
+
+    for (n++; n < count && (size_t)-1 != count; n++) {
+        if (sizeof(unsigned short) == nElem)
+            *pDst16-- = '\0';
+        else
+            *pDst8-- = '\0';
     }
 
     return pszDest;
-}
\ No newline at end of file
+}
+
+void* _cdeMemStrxCpy(IN int preset, OUT void* pszDest, IN const void* pszSource, IN  size_t count) //,IN unsigned char fBreakOnZero/* distinguish mem- vs. strcpy */,IN unsigned char fWide)
+{
+    static MEMSTRXCPYVARIANT* const rgVariant[8] = {
+        /*         */ __memMoveUp,
+        /* WID     */ __memMoveUp,
+        /* BOZ     */ __strCpy8,
+        /* BOZ WID */ __strCpy16,
+        /* TDN     */ __memMoveDn,
+        /* TDN WID */ __memMoveDn,
+        /* TDN BOZ */ __strCpyDn,
+        /* TDN BOZ WID */ __strCpyDn,
+    };
+    int idx = (PRESET_WID ? 1 : 0) + (PRESET_BOZ ? 2 : 0) + (PRESET_TDN ? 4 : 0);
+
+    return rgVariant[idx](pszDest, pszSource, count, PRESET_WID ? sizeof(unsigned short) : sizeof(unsigned char));
+}
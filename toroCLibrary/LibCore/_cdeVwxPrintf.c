@@ -31,6 +31,8 @@ VWXPRINTF _cdeVwxPrintf;
 extern void _CdeMemPutChar(int c, void** ppDest);
 extern int _cdeCoreSprintf(CDE_APP_IF* pCdeAppIf, char* pszDest, const char* pszFormat, ...);
 extern void* memset(void* s, int c, size_t n);
+extern size_t __cdeStrLen(const char* pszStr);
+extern size_t __cdeWcsLen(const unsigned short* pwcsStr);
 
 #define BUFFLEN (64 + 2)
 #define XWORD unsigned long long
@@ -410,19 +412,13 @@ static int fract2bcd(double d, DOUBLEPRINTBUF* pDblData) {
 }
 
 unsigned int _strlen(const char* pszBuffer) {
-    int i = 0;
 
-    while (pszBuffer[i] != '\0')
-        i++;
-    return i;
+    return (unsigned int)__cdeStrLen(pszBuffer);
 }
 
 unsigned int _wcslen(const short* pszBuffer) {
-    unsigned int i = 0;
 
-    while (pszBuffer[i] != '\0')
-        i++;
-    return i;
+    return (unsigned int)__cdeWcsLen((const unsigned short*)pszBuffer);
 }
 
 static int str2dev(void (*pfnDevPutChar)(int, void**), char* pszBuf, unsigned int* pCount, void** ppDest, unsigned int nMaxnum, unsigned char fWide, unsigned char IsSingle/*Char->allow '\0' to be printed*/) {
@@ -14,6 +14,12 @@ Abstract:
 
     CDE internal worker function for all of the str/wcs--pbrk/spn()-family
 
+    The set string is converted once per call into a CDECHARSET: a 256 bit
+    bitmap for the characters 0x00..0xFF and, for wide sets, the range of
+    the characters above 0xFF. Each character of the string is tested in O(1),
+    the wide set string is rescanned only for characters above 0xFF within
+    that range.
+
 Author:
 
     Kilian Kegel
@@ -21,76 +27,108 @@ Author:
 --*/
 
 #include <CdeServices.h>
-#include <stdio.h>
-
-unsigned int _strlen(const char* pszBuffer);
-unsigned int _wcslen(const short* pszBuffer);
-#define STRLEN(pszStr) (PRESET_WID ? _wcslen((short*)pszStr) : _strlen(pszStr))
 
-void* _cdeWcsStrPbrkSpn(
-    IN signed preset,
-    IN void* pszStr,
-    IN const void* pszSet
-) {
-    signed c1, c2;
-    wchar_t* pStr16 = pszStr;
-    char* pStr8 = pszStr;
-    unsigned i, iOnBreak = (unsigned)-1;
-    void* pRet;
-    int j;
-
-    unsigned char fBreak = 0;
-    signed  xcrement = PRESET_TDN ? -1 : 1;//increment vs decrement
-
-    i = PRESET_TDN ? STRLEN(pszStr) - 1 : 0;
-
-    for (pStr16 = &pStr16[i], \
-        pStr8 = &pStr8[i]; \
-
-        fBreak == 0; \
-
-        i += xcrement, \
-        pStr16 = &pStr16[xcrement], \
-        pStr8 = &pStr8[xcrement])
-    {
-
-        //c1 = (i == (unsigned)-1 ? '\0' : (PRESET_WID ? *pStr16 : *pStr8));
-        if (i == (unsigned)EOF)
-            c1 = EOF;
-        else
-            if (PRESET_WID)
-                c1 = *pStr16;
-            else
-                c1 = *pStr8;
-
-        if (c1 == '\0' || c1 == EOF) {
-            fBreak = 1;
-            iOnBreak = i;
-            break;
+extern size_t __cdeStrLen(const char* pszStr);
+extern size_t __cdeWcsLen(const unsigned short* pwcsStr);
+
+#define ISINSET(pSet, c) (1 & ((pSet)->rgBitmap[(c) >> 5] >> ((c) & 31)))
+
+/** __cdeCharSetInit() - build the character set from a set string
+**/
+void __cdeCharSetInit(OUT CDECHARSET* pSet, IN const void* pszSet, IN int fWide) {
+    const unsigned char* pSet8 = pszSet;
+    const unsigned short* pSet16 = pszSet;
+    unsigned c;
+    int i;
+
+    for (i = 0; i < 256 / 32; i++)
+        pSet->rgBitmap[i] = 0;
+
+    pSet->pSetHi = NULL;
+    pSet->wMinHi = 0xFFFF;
+    pSet->wMaxHi = 0;
+
+    if (fWide) {
+        for (/* pSet16 */; 0 != (c = *pSet16); pSet16++) {
+            if (c < 256)
+                pSet->rgBitmap[c >> 5] |= 1U << (c & 31);
+            else {
+                pSet->pSetHi = pszSet;
+                pSet->wMinHi = (unsigned short)(c < pSet->wMinHi ? c : pSet->wMinHi);
+                pSet->wMaxHi = (unsigned short)(c > pSet->wMaxHi ? c : pSet->wMaxHi);
+            }
         }
+    }
+    else {
+        for (/* pSet8 */; 0 != (c = *pSet8); pSet8++)
+            pSet->rgBitmap[c >> 5] |= 1U << (c & 31);
+    }
+}
 
-        c2 = PRESET_WID ? ((wchar_t*)pszSet)[0] : ((unsigned char*)pszSet)[0];
+/** __charSetHasWide() - test a wide character against the set
+**/
+static int __charSetHasWide(IN const CDECHARSET* pSet, IN unsigned c) {
+    const unsigned short* p;
 
-        for (j = 0; c2; c2 = PRESET_WID ? ((wchar_t*)pszSet)[++j] : ((unsigned char*)pszSet)[++j]) {
+    if (c < 256)
+        return ISINSET(pSet, c);
 
-            fBreak = (c1 == c2);
-            if (fBreak)
-                break;
+    if (c < pSet->wMinHi || c > pSet->wMaxHi)
+        return 0;
 
-        }
-        fBreak = (PRESET_INV ? (!fBreak) : fBreak);
-        iOnBreak = i;
-    }
+    for (p = pSet->pSetHi; 0 != *p; p++)
+        if (c == *p)
+            return 1;
 
-    if ((fBreak && iOnBreak != (unsigned)EOF)) {
-        if (PRESET_WID)
-            pRet = &((wchar_t*)pszStr)[iOnBreak];
-        else
-            pRet = &((char*)pszStr)[iOnBreak];
+    return 0;
+}
+
+/** __cdeCharSetScan() - find the first character that is in the set, fInv: not in the set
+
+    @retval pointer to the character found, or to the terminating '\0'
+**/
+void* __cdeCharSetScan(IN const CDECHARSET* pSet, IN const void* pszStr, IN int fWide, IN int fInv) {
+    const unsigned char* p8 = pszStr;
+    const unsigned short* p16 = pszStr;
+
+    if (fWide) {
+        while (0 != *p16 && fInv == __charSetHasWide(pSet, *p16))
+            p16++;
+        return (void*)p16;
     }
-    else
-        pRet = NULL;
 
-    return pRet;/*((fBreak && iOnBreak != (unsigned)-1)? (PRESET_WID ? &((wchar_t*)pStr16)[iOnBreak] : (wchar_t*)&((unsigned char*)pStr8)[iOnBreak]) : NULL);*/
+    while (0 != *p8 && fInv == ISINSET(pSet, *p8))
+        p8++;
+    return (void*)p8;
+}
+
+void* _cdeWcsStrPbrkSpn(
+    IN signed preset,
+    IN void* pszStr,
+    IN const void* pszSet
+) {
+    CDECHARSET Set;
+    int fInv = PRESET_INV ? 1 : 0;
+    size_t i;
+
+    __cdeCharSetInit(&Set, pszSet, PRESET_WID);
+
+    if (!PRESET_TDN)
+        return __cdeCharSetScan(&Set, pszStr, PRESET_WID, fInv);
+
+    //
+    // top down, return NULL if not found
+    //
+    if (PRESET_WID) {
+        for (i = __cdeWcsLen(pszStr); i-- > 0; /* */)
+            if (fInv != __charSetHasWide(&Set, ((unsigned short*)pszStr)[i]))
+                return &((unsigned short*)pszStr)[i];
+    }
+    else {
+        for (i = __cdeStrLen(pszStr); i-- > 0; /* */)
+            if (fInv != ISINSET(&Set, ((unsigned char*)pszStr)[i]))
+                return &((unsigned char*)pszStr)[i];
+    }
 
+    return NULL;
 }
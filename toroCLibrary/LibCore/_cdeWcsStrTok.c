@@ -21,19 +21,14 @@ Author:
 --*/
 #include <CdeServices.h>
 
-extern char* strpbrk(const char* pszStr, const char* pszSet);
-extern wchar_t* wcspbrk(const wchar_t* pszStr, const wchar_t* pszSet);
-extern size_t 	strspn(const char* pszStr, const char* pszSet);
-extern size_t 	wcsspn(const wchar_t* pszStr, const wchar_t* pszSet);
-unsigned int _strlen(const char* pszBuffer);
-unsigned int _wcslen(const short* pszBuffer);
-
+extern void __cdeCharSetInit(OUT CDECHARSET* pSet, IN const void* pszSet, IN int fWide);
+extern void* __cdeCharSetScan(IN const CDECHARSET* pSet, IN const void* pszStr, IN int fWide, IN int fInv);
 
 void* _cdeWcsStrTok(CDE_APP_IF* pCdeAppIf, IN void* pvoidStr, IN const void* pszSet, IN OUT void** ppLast, IN ROMPARM_WCSSTRTOK* pParm)
 {
+    CDECHARSET Set;
     void* pNew;
-    char* pszStr = pvoidStr, * p;
-    unsigned int (*pwcsstrlen)(const void* pszBuffer) = pParm->fWide ? (unsigned int (*)(const void*)) & _wcslen : (unsigned int (*)(const void*)) & _strlen;
+    char* pszStr = pvoidStr;
 
     do {
 
@@ -43,25 +38,14 @@ void* _cdeWcsStrTok(CDE_APP_IF* pCdeAppIf, IN void* pvoidStr, IN const void* psz
                 break;;                                         // ... yes
         }
 
-        //		(char*)pszStr += (1 + pParm->fWide) * (*pwcsstrspn)(pszStr, pszSet);
-        if (1) {
-            p = pCdeAppIf->pCdeServices->pWcsStrPbrkSpn(pParm->fWide ? WID + INV : INV, (void*)pszStr, (void*)pszSet); // strspn() / wcsspn()
+        __cdeCharSetInit(&Set, pszSet, pParm->fWide);           // build the set once for both scans
 
-            if (NULL != p) {
-                (char*)pszStr += p - pszStr;
-            }
-        }
+        pszStr = __cdeCharSetScan(&Set, pszStr, pParm->fWide, 1);  // strspn() / wcsspn()
 
-        //	    pNew = (*pwcsstrpbrk)(pszStr, pszSet);                  //find end of substring
+        pNew = __cdeCharSetScan(&Set, pszStr, pParm->fWide, 0);    // find end of substring
 
-        pNew = pCdeAppIf->pCdeServices->pWcsStrPbrkSpn(pParm->fWide ? WID : 0, (void*)pszStr, (void*)pszSet);   // find end of substring
-                                                                                                                // find end of substring
-        if (pParm->fWide)                                                                                       // find end of substring
-            if ('\0' == *((short*)pNew))                                                                        // find end of substring
-                pNew = NULL;                                                                                    // find end of substring
-            else                                                                                                // find end of substring
-                if ('\0' == *((char*)pNew))                                                                     // find end of substring
-                    pNew = NULL;                                                                                // find end of substring
+        if (pParm->fWide ? '\0' == *((short*)pNew) : '\0' == *((char*)pNew))
+            pNew = NULL;
 
         if (pNew) {                                             // if found...
             if (pParm->fWide)                                   // terminate string/wide character string
@@ -76,5 +60,5 @@ void* _cdeWcsStrTok(CDE_APP_IF* pCdeAppIf, IN void* pvoidStr, IN const void* psz
 
     } while (0);
 
-    return pszStr ? ((*pwcsstrlen)(pszStr) ? pszStr : NULL) : NULL;	//return NULL for ""
+    return pszStr ? ((pParm->fWide ? *((short*)pszStr) : *pszStr) ? pszStr : NULL) : NULL;	//return NULL for ""
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    __cdeCxxMem.c
+
+Abstract:
+
+    Toro C Library internal helperfunctions of the C++ new and delete operators
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+#include <stddef.h>
+
+extern void* __cdeGetAppIf();
+extern void* __cdeAlignedRealloc(CDE_APP_IF* pCdeAppIf, void* ptr, size_t size, size_t alignment);
+
+/**
+
+Synopsis
+
+    void* __cdeCxxNew(size_t size, size_t alignment, void* pSite);
+
+Description
+
+    Toro C Library internal helperfunction that allocates the memory of the
+    C++ new operators. alignment 0 selects native alignment.
+    pSite is the caller of the operator, passed to the heap profiler.
+
+Parameters
+
+    size_t size         :   size in bytes
+    size_t alignment    :   0 or power of two
+    void* pSite         :   allocation site
+
+Returns
+
+    pointer to the memory block on SUCCESS
+    NULL on FAILURE
+
+**/
+void* __cdeCxxNew(size_t size, size_t alignment, void* pSite) {
+    CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
+
+    CDE_SET_HEAPSITE(pCdeAppIf->pCdeServices, pSite);
+
+    if (0 == alignment)
+        return pCdeAppIf->pCdeServices->pMemRealloc(pCdeAppIf, NULL, size, &pCdeAppIf->pCdeServices->HeapStart);
+
+    return __cdeAlignedRealloc(pCdeAppIf, NULL, size, alignment);
+}
+
+/**
+
+Synopsis
+
+    void __cdeCxxDelete(void* ptr, size_t size, size_t alignment, void* pSite);
+
+Description
+
+    Toro C Library internal helperfunction that releases the memory of the
+    C++ delete operators. size 0 is an unsized delete, alignment 0 a delete
+    of a natively aligned object.
+    Sized delete passes the size of the object to pMemSizedFree(): objects that
+    fit into a slab slot are released to their slab page, identified by the
+    page header, bypassing the free() path.
+
+Parameters
+
+    void* ptr           :   memory block or NULL
+    size_t size         :   size in bytes or 0
+    size_t alignment    :   0 or power of two
+    void* pSite         :   allocation site
+
+Returns
+
+    void
+
+**/
+void __cdeCxxDelete(void* ptr, size_t size, size_t alignment, void* pSite) {
+    CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
+
+    if (NULL == ptr)
+        return;
+
+    CDE_SET_HEAPSITE(pCdeAppIf->pCdeServices, pSite);
+
+    if (0 != alignment)
+        __cdeAlignedRealloc(pCdeAppIf, ptr, 0, alignment);
+    else if (0 == size || !CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices))
+        pCdeAppIf->pCdeServices->pMemRealloc(pCdeAppIf, ptr, 0, &pCdeAppIf->pCdeServices->HeapStart);
+    else
+        pCdeAppIf->pCdeServices->pMemSizedFree(pCdeAppIf, ptr, size, &pCdeAppIf->pCdeServices->HeapStart);
+}
@@ -8,19 +8,47 @@
 
 Module Name:
 
-    new.c
+    deletea.cpp
 
 Abstract:
 
-    Implementation of the C++ delete[] operator
+    Implementation of the C++ delete[] operators
+    plain, sized, aligned and nothrow.
+    Sized delete releases small objects to their slab size class directly
 
 Author:
 
     Kilian Kegel
 
 --*/
-#include <stdlib.h>
-void operator delete[](void* ptr)
+#include <_cxxnew.h>
+
+void operator delete[](void* ptr) noexcept
+{
+    __cdeCxxDelete(ptr, 0, 0, _ReturnAddress());
+}
+
+void operator delete[](void* ptr, size_t size) noexcept
+{
+    __cdeCxxDelete(ptr, size, 0, _ReturnAddress());
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept
+{
+    __cdeCxxDelete(ptr, 0, (size_t)alignment, _ReturnAddress());
+}
+
+void operator delete[](void* ptr, size_t size, std::align_val_t alignment) noexcept
+{
+    __cdeCxxDelete(ptr, size, (size_t)alignment, _ReturnAddress());
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    __cdeCxxDelete(ptr, 0, 0, _ReturnAddress());
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept
 {
-    free(ptr);
+    __cdeCxxDelete(ptr, 0, (size_t)alignment, _ReturnAddress());
 }
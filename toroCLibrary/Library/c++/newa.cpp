@@ -8,24 +8,46 @@
 
 Module Name:
 
-    new.c
+    newa.cpp
 
 Abstract:
 
-    Implementation of the C++ new[] operator
+    Implementation of the C++ new[] operators
+    plain, aligned and nothrow
 
 Author:
 
     Kilian Kegel
 
 --*/
-#include <stdlib.h>
+#include <_cxxnew.h>
+
 void* operator new[](size_t size)
 {
-    void* p = malloc(size);
+    void* p = __cdeCxxNew(size, 0, _ReturnAddress());
 
     if ((void*)NULL == p)
         abort();
 
     return p;
 }
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    void* p = __cdeCxxNew(size, (size_t)alignment, _ReturnAddress());
+
+    if ((void*)NULL == p)
+        abort();
+
+    return p;
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return __cdeCxxNew(size, 0, _ReturnAddress());
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return __cdeCxxNew(size, (size_t)alignment, _ReturnAddress());
+}
@@ -20,8 +20,11 @@ Author:
     Kilian Kegel
 
 --*/
+#include <uefi.h>
 #include <stdio.h>
+#include <CdeServices.h>
 
+extern int __cdeIsFilePointer(void* stream);
 extern void (*pinvalid_parameter_handler)(const wchar_t* expression, const wchar_t* function, const wchar_t* file, unsigned int line, unsigned* pReserved);
 
 /** fgetc
@@ -51,6 +54,7 @@ Returns
 **/
 int fgetc(FILE* stream) {
 
+    CDEFILE* pCdeFile = (CDEFILE*)stream;
     unsigned int nRet = (size_t)EOF;
     char c;
 
@@ -59,6 +63,16 @@ int fgetc(FILE* stream) {
     else
         do {
 
+            if (__cdeIsFilePointer(pCdeFile) && CDE_FGETC_INBUF(pCdeFile)) {
+                //
+                // fast path: character available in the buffer, update the buffer state as fread() does
+                //
+                pCdeFile->bclean = TRUE;
+                pCdeFile->fEof = FALSE;
+                nRet = (unsigned char)pCdeFile->Buffer[pCdeFile->bidx++];
+                break;
+            }
+
             if (1 != fread(&c, 1, 1, stream))
                 break;
             nRet = (unsigned char)c;
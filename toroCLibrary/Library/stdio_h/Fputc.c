@@ -24,6 +24,8 @@ Author:
 #include <stdio.h>
 #include <CdeServices.h>
 
+extern int __cdeIsFilePointer(void* stream);
+
 /** fputc
 Synopsis
     #include <stdio.h>
@@ -49,11 +51,23 @@ Returns
 
 **/
 int fputc(int b, FILE* stream) {
+    CDEFILE* pCdeFile = (CDEFILE*)stream;
     unsigned int nRet = (size_t)EOF;
     unsigned char c = (unsigned char)b;
 
     do {
 
+        if (__cdeIsFilePointer(pCdeFile) && CDE_FPUTC_INBUF(pCdeFile, c)) {
+            //
+            // fast path: buffer can take the character without flush, update the buffer state as fwrite() does
+            //
+            pCdeFile->Buffer[pCdeFile->bidx++] = c;
+            pCdeFile->bvld++;
+            pCdeFile->bdirty = TRUE;
+            nRet = c;
+            break;
+        }
+
         if (1 != fwrite(&c, 1, 1, stream))
             break;
         nRet = (unsigned char)c;
@@ -101,6 +101,36 @@ size_t fread(const void* ptr, size_t size, size_t nelem, FILE* stream) {
                     fposoosync = FALSE;
                 }
 
+                //
+                // binary mode, at least one buffer size remaining: read directly to ptr,
+                // keep the last byte read in the buffer, so that ungetc() can push back one character
+                //
+                if (0 == (pCdeFile->openmode & O_TEXT) && requested - provided >= (size_t)pCdeFile->bsiz) {
+
+                    size_t remaining = requested - provided;
+
+                    lastnum = pCdeAppIf->pCdeServices->pFread(pCdeAppIf, &((char*)ptr)[provided], remaining, pCdeFile);
+
+                    pCdeFile->fEof = 0 == lastnum ? TRUE : FALSE;
+                    pCdeFile->bpos += lastnum;
+                    fposoosync = remaining != lastnum ? TRUE : FALSE;
+                    provided += lastnum;
+
+                    if (0 == lastnum) {
+                        pCdeFile->bufPosEOF = 0;                                // EOF at the beginning of the empty buffer
+                        pCdeFile->bidx = 0;
+                        pCdeFile->bvld = 0;
+                        break;
+                    }
+
+                    pCdeFile->Buffer[0] = ((char*)ptr)[provided - 1];           // the last byte read is the entire buffer
+                    pCdeFile->bufPosEOF = remaining != lastnum ? 1 : LONG_MAX;  // EOF behind the last byte
+                    pCdeFile->bidx = 1;
+                    pCdeFile->bvld = 1;
+                    lastnum = 1;                                                // bpos is the position of the buffer end, as after a refill
+                    continue;
+                }
+
                 lastnum = pCdeAppIf->pCdeServices->pFread(pCdeAppIf, pCdeFile->Buffer, pCdeFile->bsiz, pCdeFile);
 
                 //
@@ -119,6 +149,23 @@ size_t fread(const void* ptr, size_t size, size_t nelem, FILE* stream) {
                     break;
             }
 
+            //
+            // binary mode: copy the entire run available in the buffer
+            //
+            if (0 == (pCdeFile->openmode & O_TEXT)) {
+
+                size_t run = (size_t)(pCdeFile->bvld - pCdeFile->bidx);
+
+                if (run > requested - provided)
+                    run = requested - provided;
+
+                memcpy(&((char*)ptr)[provided], &pCdeFile->Buffer[pCdeFile->bidx], run);
+                pCdeFile->bidx += (long)run;
+                pCdeFile->bclean = TRUE;
+                provided += run;
+                continue;
+            }
+
             for (/* provided = 0 , requested = size * nelem */; (provided + skipped) < requested && pCdeFile->bidx < pCdeFile->bvld && pCdeFile->fCtrlZ == FALSE; /* do nothing */)
             {
 
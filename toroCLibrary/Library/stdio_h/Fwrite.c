@@ -77,6 +77,57 @@ size_t fwrite(const void* ptr, size_t size, size_t nelem, FILE* stream) {
 
         for (provided = 0, requested = size * nelem, lastnum = 0, fCRinserted = FALSE; (flushbuf || provided < requested); flushbuf = FALSE)
         {
+            //
+            // binary mode, buffer empty and at least one buffer size remaining: write directly from ptr
+            //
+            if (0 == (pCdeFile->openmode & O_TEXT) 
+                && 0 == pCdeFile->bidx 
+                && 0 == pCdeFile->bvld 
+                && requested - provided >= (size_t)pCdeFile->bsiz
+                && O_RDONLY != (pCdeFile->openmode & (O_RDONLY | O_WRONLY | O_RDWR)))
+            {
+                size_t remaining = requested - provided;
+
+                if (fposoosync) {
+                    pCdeAppIf->pCdeServices->pFsetpos(pCdeAppIf, pCdeFile, (CDEFPOS_T*)&pCdeFile->bpos);
+                    fposoosync = FALSE;
+                }
+
+                lastnum = pCdeAppIf->pCdeServices->pFwrite(pCdeAppIf, &((char*)ptr)[provided], remaining, pCdeFile);
+
+                pCdeFile->bpos += lastnum;
+                pCdeFile->bdirty = FALSE;
+                pCdeFile->bclean = FALSE;
+                provided += lastnum;
+
+                if (remaining != lastnum)
+                    break;                                                      // write error
+                continue;
+            }
+
+            //
+            // binary mode: copy the entire run that fits into the buffer
+            //
+            if (0 == (pCdeFile->openmode & O_TEXT)) {
+
+                size_t run = (size_t)(pCdeFile->bsiz - pCdeFile->bidx);
+
+                if (run > requested - provided)
+                    run = requested - provided;
+
+                if (0 != run) {
+                    memcpy(&pCdeFile->Buffer[pCdeFile->bidx], &((char*)ptr)[provided], run);
+                    pCdeFile->bidx += (long)run;
+                    //
+                    // NOTE: If the buffer of a readonly-file is written, pCdeFile->bvld must not be updated
+                    //
+                    if (O_RDONLY != (pCdeFile->openmode & (O_RDONLY | O_WRONLY | O_RDWR))) {
+                        pCdeFile->bvld += (long)run;
+                    }
+                    pCdeFile->bdirty = TRUE;
+                    provided += run;
+                }
+            }
 
             for (/* provided = 0 , requested = size * nelem */; provided < requested && pCdeFile->bidx < pCdeFile->bsiz; /* do nothing */)
             {
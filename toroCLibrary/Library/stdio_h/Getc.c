@@ -21,9 +21,12 @@ Author:
     Kilian Kegel
 
 --*/
+#include <uefi.h>
 #include <stdio.h>
+#include <CdeServices.h>
 
 extern int fgetc(FILE* stream);
+extern int __cdeIsFilePointer(void* stream);
 
 /** 
 Synopsis
@@ -42,5 +45,13 @@ Returns
 **/
 int getc(FILE * stream) 
 {
+    CDEFILE* pCdeFile = (CDEFILE*)stream;
+
+    if (NULL != stream && __cdeIsFilePointer(pCdeFile) && CDE_FGETC_INBUF(pCdeFile)) {
+        pCdeFile->bclean = TRUE;
+        pCdeFile->fEof = FALSE;
+        return (unsigned char)pCdeFile->Buffer[pCdeFile->bidx++];
+    }
+
     return fgetc(stream);
 }
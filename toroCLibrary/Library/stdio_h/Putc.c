@@ -20,7 +20,11 @@ Author:
     Kilian Kegel
 
 --*/
+#include <uefi.h>
 #include <stdio.h>
+#include <CdeServices.h>
+
+extern int __cdeIsFilePointer(void* stream);
 
 /** fputc
 Synopsis
@@ -40,5 +44,15 @@ Returns
 
 **/
 int putc(int b, FILE* stream) {
+    CDEFILE* pCdeFile = (CDEFILE*)stream;
+    unsigned char c = (unsigned char)b;
+
+    if (__cdeIsFilePointer(pCdeFile) && CDE_FPUTC_INBUF(pCdeFile, c)) {
+        pCdeFile->Buffer[pCdeFile->bidx++] = c;
+        pCdeFile->bvld++;
+        pCdeFile->bdirty = TRUE;
+        return c;
+    }
+
     return fputc(b, stream);
 }
\ No newline at end of file
@@ -24,8 +24,6 @@ Author:
 #include <errno.h>
 #include <CdeServices.h>
 
-extern int __cdeOnErrSet_errno(CDE_STATUS Status, int Error);
-
 /**
 
 Synopsis
@@ -37,6 +35,10 @@ Description
     Toro C Library internal helperfunction that validates, if a FILE* pointer 
     belongs to the internal I/O buffer
 
+    The stream is checked in O(1) by its offset into the _iob[] array pCdeAppIf->pIob:
+    it must be inside the array, a multiple of sizeof(CDEFILE) and the file must be
+    taken (fRsv).
+
     It set errno to EBADF on fail.
 
 Parameters
@@ -50,19 +52,29 @@ Returns
 
 **/
 int __cdeIsFilePointer(void* stream) {
-    int j;
-    void* pCdeFile;
-    EFI_STATUS Status = (EFI_STATUS)-1;
-
-    for (j = 0, pCdeFile = __cdeGetIOBuffer(0)/*&_iob[0]*/; NULL != pCdeFile; pCdeFile = __cdeGetIOBuffer(++j))
-    {
-        if (pCdeFile == stream && TRUE == ((CDEFILE*)pCdeFile)->fRsv) {
-            Status = EFI_SUCCESS;
+    CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
+    size_t ofs;
+    int nRet = 0;
+
+    do {
+
+        if (NULL == pCdeAppIf || NULL == pCdeAppIf->pIob || 0 >= pCdeAppIf->cIob)
+            break;                                                      // no _iob[], e.g. PEI, DXE, SMM
+
+        ofs = (size_t)stream - (size_t)pCdeAppIf->pIob;                 // NOTE: stream below _iob[] wraps around to a huge offset
+
+        if (ofs >= (size_t)pCdeAppIf->cIob * sizeof(CDEFILE) || 0 != ofs % sizeof(CDEFILE))
+            break;
+
+        if (TRUE != ((CDEFILE*)stream)->fRsv)
             break;
-        }
-    }
 
-    __cdeOnErrSet_errno(Status, EBADF);
+        nRet = 1 + (int)(ofs / sizeof(CDEFILE));
+
+    } while (0);
+
+    if (0 == nRet)
+        errno = EBADF;
 
-    return EFI_SUCCESS == Status ? 1 + j : 0;
-}
+    return nRet;
+}
\ No newline at end of file
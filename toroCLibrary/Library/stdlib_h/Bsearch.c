@@ -0,0 +1,64 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    Bsearch.c
+
+Abstract:
+
+    Implementation of the Standard C function.
+    Performs a binary search of a sorted array.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stddef.h>
+
+/**
+
+Synopsis
+    #include <stdlib.h>
+    void *bsearch(const void *key, const void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *));
+Description
+    https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/bsearch?view=msvc-160
+    The bsearch function searches an array of nmemb objects, the initial element of which is
+    pointed to by base, for an element that matches the object pointed to by key. The size of
+    each element of the array is specified by size.
+
+    The comparison function pointed to by compar is called with two arguments that point to
+    the key object and to an array element, in that order.
+Returns
+    The bsearch function returns a pointer to a matching element of the array, or a null
+    pointer if no match is found. If two elements compare as equal, which element is matched
+    is unspecified.
+
+**/
+void* bsearch(const void* key, const void* base, size_t num, size_t width, int (*compar)(const void*, const void*)) {
+    const unsigned char* p = base;
+    size_t lo = 0, hi = num, mid;
+    int diff;
+
+    while (lo < hi) {
+
+        mid = lo + (hi - lo) / 2;
+        diff = (*compar)(key, p + mid * width);
+
+        if (0 == diff)
+            return (void*)(p + mid * width);
+
+        if (diff < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return NULL;
+}
@@ -0,0 +1,65 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    Bsearch_s.c
+
+Abstract:
+
+    Implementation of the Microsoft C function.
+    Performs a binary search of a sorted array, with a context pointer passed to the compare function.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stddef.h>
+#include <errno.h>
+
+/**
+
+Synopsis
+    #include <stdlib.h>
+    void* bsearch_s(const void* key, const void* base, size_t number, size_t width, int (*compare)(void*, const void*, const void*), void* context);
+Description
+    https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/bsearch-s?view=msvc-160
+    The bsearch_s function searches a sorted array of number elements of width bytes for key,
+    the context pointer is passed to each call of the compare function.
+Returns
+    The bsearch_s function returns a pointer to a matching element of the array, or NULL if
+    no match is found. errno is set to EINVAL for invalid parameters.
+
+**/
+void* bsearch_s(const void* key, const void* base, size_t number, size_t width, int (*compare)(void*, const void*, const void*), void* context) {
+    const unsigned char* p = base;
+    size_t lo = 0, hi = number, mid;
+    int diff;
+
+    if (NULL == compare || (0 != number && (NULL == key || NULL == base || 0 == width))) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    while (lo < hi) {
+
+        mid = lo + (hi - lo) / 2;
+        diff = (*compare)(context, key, p + mid * width);
+
+        if (0 == diff)
+            return (void*)(p + mid * width);
+
+        if (diff < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return NULL;
+}
@@ -20,8 +20,12 @@ Author:
     Kilian Kegel
 
 --*/
+#include <CdeServices.h>
 #include <string.h>
 #include <stdlib.h>
+#include <intrin.h>
+
+extern void* __cdeGetAppIf();
 
 /**
 
@@ -32,15 +36,23 @@ Description
     https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/calloc?view=msvc-160&viewFallbackFrom=vs-2019
     The calloc function allocates space for an array of nmemb
     objects, each of whose size is size. The space is initialized to all bits zero.
+
+    NOTE: memset() is skipped, if the suballocator reports the block as taken
+          from zeroed pages, fresh from the OSIF
 Returns
     The calloc function returns either a null pointer or a pointer to the allocated space.
 **/
 
 void* calloc(size_t nmemb, size_t size) {
-    void* pRet;
-    pRet = realloc(0, nmemb * size);
-    if (pRet) {
-        memset(pRet, 0, nmemb * size);
+    CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
+    void* pRet = NULL;
+
+    if (0 == nmemb || (nmemb * size) / nmemb == size) {             // multiplication overflow check
+        CDE_SET_HEAPSITE(pCdeAppIf->pCdeServices, _ReturnAddress());  // allocation site for the heap profiler
+        pRet = pCdeAppIf->pCdeServices->pMemRealloc(pCdeAppIf, NULL, nmemb * size, &pCdeAppIf->pCdeServices->HeapStart);
+        if (pRet && (!CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices) || pRet != pCdeAppIf->pCdeServices->HeapCtrl.pKnownZero)) {
+            memset(pRet, 0, nmemb * size);
+        }
     }
     return pRet;
 }
\ No newline at end of file
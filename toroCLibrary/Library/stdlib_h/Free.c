@@ -20,7 +20,11 @@ Author:
     Kilian Kegel
 
 --*/
-#include <stdlib.h>
+#include <CdeServices.h>
+#include <stddef.h>
+#include <intrin.h>
+
+extern void* __cdeGetAppIf();
 
 /**
 
@@ -35,5 +39,14 @@ Returns
     https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/free?view=msvc-160#remarks
 **/
 void free(void* ptr) {
-    realloc(ptr, 0);
+    CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
+
+    CDE_SET_HEAPSITE(pCdeAppIf->pCdeServices, _ReturnAddress());  // allocation site for the heap profiler
+
+    pCdeAppIf->pCdeServices->pMemRealloc(
+        pCdeAppIf,
+        ptr,    //IN void *ptr,   /* input pointer for realloc */
+        0,      //IN size_t size, /*  input size for realloc*/
+        &pCdeAppIf->pCdeServices->HeapStart
+    );
 }
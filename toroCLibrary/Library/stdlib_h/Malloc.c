@@ -20,7 +20,12 @@ Author:
     Kilian Kegel
 
 --*/
+#include <CdeServices.h>
 #include <stddef.h>
+#include <intrin.h>
+
+extern void* __cdeGetAppIf();
+
 /**
 
 Synopsis
@@ -33,8 +38,15 @@ Parameters
 Returns
     https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/malloc?view=msvc-160#return-value
 **/
-extern void* realloc(void* ptr, size_t size);
-
 void* malloc(size_t size) {
-    return realloc(0, size);
+    CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
+
+    CDE_SET_HEAPSITE(pCdeAppIf->pCdeServices, _ReturnAddress());  // allocation site for the heap profiler
+
+    return pCdeAppIf->pCdeServices->pMemRealloc(
+        pCdeAppIf,
+        NULL,   //IN void *ptr,   /* input pointer for realloc */
+        size,   //IN size_t size, /*  input size for realloc*/
+        &pCdeAppIf->pCdeServices->HeapStart
+    );
 }
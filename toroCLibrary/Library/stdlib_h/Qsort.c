@@ -20,9 +20,9 @@ Author:
     Kilian Kegel
 
 --*/
-#include <stddef.h>
+#include <CdeServices.h>
 
-#define ELC(x) (sizeof(x) / sizeof(x[0]))
+extern void __cdeIntroSort(void* base, size_t num, CDESORTPARM* pParm);
 
 /**
 
@@ -45,39 +45,8 @@ Returns
     The qsort function returns no value.
 
 **/
-static int swap(const void* p01, const void* p02, size_t width)
-{
-    char* p1 = (void*)p01, * p2 = (void*)p02;
-    char c;
-    int i;
-
-    for (i = 0; i < (int)width; i++)
-        c = p1[i], p1[i] = p2[i], p2[i] = c;
-    return 0;
-}
-
 void qsort(void* base, size_t num, size_t width, int (*compar) (const void*, const void*)) {
+    CDESORTPARM SortParm = { compar, NULL, NULL, width, NULL };
 
-    char* p1, * p2, * px1, * px2, * pb;
-    int diff;
-    size_t n;
-
-    while (num--) {
-
-        for (pb = p1 = (char*)base, p2 = &p1[width], n = 0, px1 = px2 = NULL; p2 < &pb[width * (num + 1)]; p2 = &p2[width], n++/*, px1 = NULL*/)
-        {
-
-            diff = (*compar)(p2, p1);
-
-            if (diff > 0)
-                p1 = p2;
-
-            if (diff < 0)
-                px1 = p1, px2 = p2;
-        }
-
-        if (NULL != px1)
-            swap(px1, px2, width);
-
-    };
+    __cdeIntroSort(base, num, &SortParm);
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    Qsort_s.c
+
+Abstract:
+
+    Implementation of the Microsoft C function.
+    Performs a sort, with a context pointer passed to the compare function.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+#include <errno.h>
+
+extern void __cdeIntroSort(void* base, size_t num, CDESORTPARM* pParm);
+
+/**
+
+Synopsis
+    #include <stdlib.h>
+    void qsort_s(void* base, size_t num, size_t width, int (*compare)(void*, const void*, const void*), void* context);
+Description
+    https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/qsort-s?view=msvc-160
+    The qsort_s function sorts an array of num elements of width bytes into ascending order,
+    the context pointer is passed to each call of the compare function.
+Returns
+    The qsort_s function returns no value. errno is set to EINVAL for invalid parameters.
+
+**/
+void qsort_s(void* base, size_t num, size_t width, int (*compare)(void*, const void*, const void*), void* context) {
+    CDESORTPARM SortParm = { NULL, compare, context, width, NULL };
+
+    if (NULL == compare || (NULL == base && 0 != num) || (0 == width && 0 != num)) {
+        errno = EINVAL;
+        return;
+    }
+
+    __cdeIntroSort(base, num, &SortParm);
+}
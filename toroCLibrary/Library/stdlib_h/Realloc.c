@@ -24,6 +24,7 @@ Author:
 #include <string.h>
 #include <stdarg.h>
 #include <stddef.h>
+#include <intrin.h>
 
 extern void* __cdeGetAppIf();
 
@@ -44,6 +45,8 @@ void* realloc(void* ptr, size_t size) {
     CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
     void* pRet;
 
+    CDE_SET_HEAPSITE(pCdeAppIf->pCdeServices, _ReturnAddress());  // allocation site for the heap profiler
+
     pRet = pCdeAppIf->pCdeServices->pMemRealloc(
         pCdeAppIf,
         ptr,    //IN void *ptr,   /* input pointer for realloc */
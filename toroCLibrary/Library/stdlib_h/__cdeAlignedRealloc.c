@@ -0,0 +1,95 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    __cdeAlignedRealloc.c
+
+Abstract:
+
+    Toro C Library internal helperfunction of the aligned memory allocation functions
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+#include <string.h>
+#include <stddef.h>
+
+#define ALIGNHDX (2 * sizeof(size_t))   /* original pointer and size in front of the aligned block */
+
+/**
+
+Synopsis
+
+    void* __cdeAlignedRealloc(CDE_APP_IF* pCdeAppIf, void* ptr, size_t size, size_t alignment);
+
+Description
+
+    Toro C Library internal helperfunction of _aligned_malloc(), _aligned_realloc(),
+    _aligned_free() and of the aligned C++ new and delete operators.
+    size 0 releases the memory block.
+
+    The memory block is taken from pMemAlignedRealloc(). CdeServices drivers of CDE_SERVICES
+    version 0.0 don't provide pMemAlignedRealloc(), in that case the memory block is
+    over-allocated by pMemRealloc() and aligned manually. The original pointer and the size
+    are stored in front of the aligned memory block.
+
+Parameters
+
+    CDE_APP_IF* pCdeAppIf
+    void* ptr           :   memory block or NULL
+    size_t size         :   size in bytes
+    size_t alignment    :   power of two
+
+Returns
+
+    pointer to the memory block on SUCCESS
+    NULL on FAILURE
+
+**/
+void* __cdeAlignedRealloc(CDE_APP_IF* pCdeAppIf, void* ptr, size_t size, size_t alignment) {
+    HEAPDESC* pHeapStart = &pCdeAppIf->pCdeServices->HeapStart;
+    unsigned char* pRaw, * pRet = NULL;
+    size_t* pHdr;
+
+    if (CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices))
+        return pCdeAppIf->pCdeServices->pMemAlignedRealloc(pCdeAppIf, ptr, size, alignment, pHeapStart);
+
+    do {
+
+        if (0 != size) {
+
+            if (size > ~(size_t)0 - alignment - ALIGNHDX)               // prevent overflow of size calculation
+                break;
+
+            pRaw = pCdeAppIf->pCdeServices->pMemRealloc(pCdeAppIf, NULL, size + alignment + ALIGNHDX, pHeapStart);
+            if (NULL == pRaw)
+                break;                                                  // keep ptr, as realloc() does
+
+            pRet = (unsigned char*)(((size_t)pRaw + ALIGNHDX + alignment - 1) & ~(alignment - 1));
+            pHdr = (size_t*)pRet;
+            pHdr[-1] = (size_t)pRaw;
+            pHdr[-2] = size;
+        }
+
+        if (NULL != ptr) {
+            pHdr = (size_t*)ptr;
+
+            if (NULL != pRet)
+                memcpy(pRet, ptr, size < pHdr[-2] ? size : pHdr[-2]);
+
+            pCdeAppIf->pCdeServices->pMemRealloc(pCdeAppIf, (void*)pHdr[-1], 0, pHeapStart);
+        }
+
+    } while (0);
+
+    return pRet;
+}
@@ -0,0 +1,51 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    _aligned_free.c
+
+Abstract:
+
+    Implementation of the Microsoft C function.
+    Releases an aligned memory block.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+#include <stddef.h>
+#include <intrin.h>
+
+extern void* __cdeGetAppIf();
+extern void* __cdeAlignedRealloc(CDE_APP_IF* pCdeAppIf, void* ptr, size_t size, size_t alignment);
+
+/**
+
+Synopsis
+    #include <malloc.h>
+    void _aligned_free(void* memblock);
+Description
+    https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/aligned-free?view=msvc-170
+    Aligned memory blocks are native memory blocks of the suballocator, that are released by free().
+    With CdeServices drivers of CDE_SERVICES version 0.0 the memory blocks are aligned manually
+    and must be released by _aligned_free().
+Parameters
+    https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/aligned-free?view=msvc-170#parameters
+Returns
+    https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/aligned-free?view=msvc-170#return-value
+**/
+void _aligned_free(void* memblock) {
+    CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
+
+    CDE_SET_HEAPSITE(pCdeAppIf->pCdeServices, _ReturnAddress());  // allocation site for the heap profiler
+
+    __cdeAlignedRealloc(pCdeAppIf, memblock, 0, CDE_HEAP_ALIGN);
+}
@@ -0,0 +1,57 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    _aligned_realloc.c
+
+Abstract:
+
+    Implementation of the Microsoft C function.
+    Reallocates an aligned memory block.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+#include <errno.h>
+#include <stddef.h>
+#include <intrin.h>
+
+extern void* __cdeGetAppIf();
+extern void* __cdeAlignedRealloc(CDE_APP_IF* pCdeAppIf, void* ptr, size_t size, size_t alignment);
+
+/**
+
+Synopsis
+    #include <malloc.h>
+    void* _aligned_realloc(void* memblock, size_t size, size_t alignment);
+Description
+    https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/aligned-realloc?view=msvc-170
+Parameters
+    https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/aligned-realloc?view=msvc-170#parameters
+Returns
+    https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/aligned-realloc?view=msvc-170#return-value
+**/
+void* _aligned_realloc(void* memblock, size_t size, size_t alignment) {
+    CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
+    void* pRet = NULL;
+
+    if (0 == alignment || 0 != (alignment & (alignment - 1)))
+        errno = EINVAL;
+    else {
+        CDE_SET_HEAPSITE(pCdeAppIf->pCdeServices, _ReturnAddress());  // allocation site for the heap profiler
+        pRet = __cdeAlignedRealloc(pCdeAppIf, memblock, size, alignment);
+        if (NULL == pRet && 0 != size)
+            errno = ENOMEM;
+    }
+
+    return pRet;
+}
@@ -0,0 +1,265 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    _cdeMergeSort.c
+
+Abstract:
+
+    Toro C Library specific function.
+    Stable natural merge sort with a context pointer passed to the compare function.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+#include <errno.h>
+#include <intrin.h>
+
+#define MINRUN 16
+#define CMP(p, a, b) (*(p)->pfnCmpCtx)((p)->pContext, a, b)
+#define EL(i) (base + (i) * width)
+
+extern void* __cdeGetAppIf();
+extern void* __cdeMemCpyFwd(void* pDst, const void* pSrc, size_t n);
+extern void* __cdeMemCpyBwd(void* pDst, const void* pSrc, size_t n);
+
+/** __reverse() - reverse the order of num elements
+**/
+static void __reverse(unsigned char* base, size_t num, size_t width) {
+    unsigned char* p1 = base;
+    unsigned char* p2 = base + (num - 1) * width;
+    unsigned char c;
+    size_t i;
+
+    for (/* p1, p2 */; p1 < p2; p1 += width, p2 -= width)
+        for (i = 0; i < width; i++)
+            c = p1[i], p1[i] = p2[i], p2[i] = c;
+}
+
+/** __runLength() - length of the ascending run at base, a strictly descending run is reversed
+
+    @retval number of elements of the run
+**/
+static size_t __runLength(unsigned char* base, size_t num, CDESORTPARM* pParm) {
+    size_t width = pParm->width;
+    size_t i = 1;
+
+    if (num < 2)
+        return num;
+
+    if (CMP(pParm, EL(0), EL(1)) > 0) {
+        for (i = 2; i < num && CMP(pParm, EL(i - 1), EL(i)) > 0; i++)
+            ;
+        __reverse(base, i, width);                          // strictly descending, reversing keeps it stable
+    }
+    else {
+        for (i = 2; i < num && CMP(pParm, EL(i - 1), EL(i)) <= 0; i++)
+            ;
+    }
+
+    return i;
+}
+
+/** __binaryInsertion() - extend the sorted run of nSorted elements to num elements
+**/
+static void __binaryInsertion(unsigned char* base, size_t num, size_t nSorted, unsigned char* pTmp, CDESORTPARM* pParm) {
+    size_t width = pParm->width;
+    size_t k, lo, hi, mid;
+
+    for (k = nSorted; k < num; k++) {
+
+        __cdeMemCpyFwd(pTmp, EL(k), width);
+
+        for (lo = 0, hi = k; lo < hi; /* */) {             // behind the last equal element
+            mid = lo + (hi - lo) / 2;
+            if (CMP(pParm, pTmp, EL(mid)) < 0)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+
+        __cdeMemCpyBwd(EL(lo + 1), EL(lo), (k - lo) * width);
+        __cdeMemCpyFwd(EL(lo), pTmp, width);
+    }
+}
+
+/** __merge() - merge the adjacent sorted runs lo..mid-1 and mid..hi-1
+
+    The shorter run is copied to pBuf, so pBuf holds at least half of the elements.
+**/
+static void __merge(unsigned char* base, size_t lo, size_t mid, size_t hi, unsigned char* pBuf, CDESORTPARM* pParm) {
+    size_t width = pParm->width;
+    size_t i, j, d;
+
+    if (CMP(pParm, EL(mid - 1), EL(mid)) <= 0)              // already in order
+        return;
+
+    if (mid - lo <= hi - mid) {
+
+        //
+        // left run to pBuf, merge from lower to higher addresses
+        //
+        __cdeMemCpyFwd(pBuf, EL(lo), (mid - lo) * width);
+
+        for (i = 0, j = mid, d = lo; i < mid - lo && j < hi; d++) {
+            if (CMP(pParm, EL(j), pBuf + i * width) < 0)
+                __cdeMemCpyFwd(EL(d), EL(j++), width);
+            else
+                __cdeMemCpyFwd(EL(d), pBuf + i++ * width, width);
+        }
+
+        __cdeMemCpyFwd(EL(d), pBuf + i * width, (mid - lo - i) * width);
+    }
+    else {
+
+        //
+        // right run to pBuf, merge from higher to lower addresses
+        //
+        __cdeMemCpyFwd(pBuf, EL(mid), (hi - mid) * width);
+
+        for (i = mid, j = hi - mid, d = hi; i > lo && j > 0; /* */) {
+            d--;
+            if (CMP(pParm, pBuf + (j - 1) * width, EL(i - 1)) < 0)
+                __cdeMemCpyFwd(EL(d), EL(--i), width);
+            else
+                __cdeMemCpyFwd(EL(d), pBuf + --j * width, width);
+        }
+
+        __cdeMemCpyFwd(EL(lo), pBuf, j * width);
+    }
+}
+
+/** _cdeMergeSort()
+
+Synopsis
+
+    int _cdeMergeSort(
+        void* base,
+        size_t num,
+        size_t width,
+        int (*compare)(void* context, const void*, const void*),
+        void* context,
+        CDEARENA* pArena
+    )
+
+Description
+
+    Sort num elements of width bytes into ascending order, elements that compare equal keep
+    their order (stable).
+
+    Ascending runs and strictly descending runs of the input are detected in O(n). Already
+    ordered input, or input in reverse order, is sorted in n - 1 compares without scratch
+    memory. Otherwise runs shorter than MINRUN elements are extended by binary insertion, and
+    adjacent runs are merged pairwise.
+
+    The scratch buffer of about num / 2 elements is taken from the arena pArena, if given,
+    and from the heap otherwise, or if the CdeServices driver doesn't provide arenas.
+
+Returns
+
+    @param[in] void* base
+    @param[in] size_t num
+    @param[in] size_t width
+    @param[in] int (*compare)(void* context, const void*, const void*)
+    @param[in] void* context
+    @param[in] CDEARENA* pArena, optional
+
+    @retval 0 on success
+            -1 on FAIL, errno is set to EINVAL for invalid parameters, to ENOMEM if the scratch
+            buffer is not available. A leading descending run may be reversed then.
+
+**/
+int _cdeMergeSort(void* pvBase, size_t num, size_t width, int (*compare)(void* context, const void*, const void*), void* context, CDEARENA* pArena) {
+    CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
+    CDESORTPARM SortParm = { NULL, compare, context, width, NULL };
+    unsigned char* base = pvBase;
+    unsigned char* pScratch;
+    unsigned char* pTmp;
+    unsigned char* pBuf;
+    size_t* rgRun;
+    size_t nRunMax, nRuns, n, p, i, k, size;
+
+    if (NULL == compare || (NULL == base && 0 != num) || (0 == width && 0 != num)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (num < 2 || num == __runLength(base, num, &SortParm))
+        return 0;
+
+    //
+    // scratch: run table, one element, half of the elements
+    //
+    nRunMax = num / MINRUN + 2;
+
+    if (width > (~(size_t)0 - nRunMax * sizeof(size_t)) / (num / 2 + 2)) {
+        errno = ENOMEM;
+        return -1;
+    }
+    size = nRunMax * sizeof(size_t) + (num / 2 + 2) * width;
+
+    if (!CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices))
+        pArena = NULL;                                              // CDE_SERVICES without arena support
+
+    if (NULL != pArena)
+        pScratch = pCdeAppIf->pCdeServices->pArenaAlloc(pCdeAppIf, pArena, size);
+    else {
+        CDE_SET_HEAPSITE(pCdeAppIf->pCdeServices, _ReturnAddress());  // allocation site for the heap profiler
+        pScratch = pCdeAppIf->pCdeServices->pMemRealloc(pCdeAppIf, NULL, size, &pCdeAppIf->pCdeServices->HeapStart);
+    }
+
+    if (NULL == pScratch) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    rgRun = (size_t*)pScratch;
+    pTmp = pScratch + nRunMax * sizeof(size_t);
+    pBuf = pTmp + width;
+
+    //
+    // split into runs of at least MINRUN elements
+    //
+    for (p = 0, nRuns = 0; p < num; p += n) {
+
+        n = __runLength(EL(p), num - p, &SortParm);
+
+        if (n < MINRUN) {
+            k = num - p < MINRUN ? num - p : MINRUN;
+            __binaryInsertion(EL(p), k, n, pTmp, &SortParm);
+            n = k;
+        }
+
+        rgRun[nRuns++] = p;
+    }
+    rgRun[nRuns] = num;
+
+    //
+    // merge adjacent runs pairwise, until one run is left
+    //
+    while (nRuns > 1) {
+
+        for (i = 0, k = 0; i < nRuns; i += 2) {
+            if (i + 1 < nRuns)
+                __merge(base, rgRun[i], rgRun[i + 1], rgRun[i + 2], pBuf, &SortParm);
+            rgRun[k++] = rgRun[i];
+        }
+
+        rgRun[k] = num;
+        nRuns = k;
+    }
+
+    if (NULL == pArena)
+        pCdeAppIf->pCdeServices->pMemRealloc(pCdeAppIf, pScratch, 0, &pCdeAppIf->pCdeServices->HeapStart);
+
+    return 0;
+}
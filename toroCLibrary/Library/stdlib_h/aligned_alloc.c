@@ -0,0 +1,76 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    aligned_alloc.c
+
+Abstract:
+
+    Implementation of the Standard C11 function.
+    Allocates an aligned memory block.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <CdeServices.h>
+#include <errno.h>
+#include <stddef.h>
+#include <intrin.h>
+
+extern void* __cdeGetAppIf();
+
+/**
+
+Synopsis
+    #include <stdlib.h>
+    void* aligned_alloc(size_t alignment, size_t size);
+Description
+    https://en.cppreference.com/w/c/memory/aligned_alloc
+    The aligned_alloc function allocates space for an object whose alignment is
+    specified by alignment, whose size is specified by size, and whose value is
+    indeterminate. The memory block is released by free().
+Returns
+    The aligned_alloc function returns either a null pointer or a pointer to the allocated space.
+    errno is set to EINVAL if alignment is not a power of two, or if the alignment
+    is not supported by a CdeServices driver of CDE_SERVICES version 0.0.
+**/
+void* aligned_alloc(size_t alignment, size_t size) {
+    CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
+    void* pRet = NULL;
+
+    if (0 == alignment || 0 != (alignment & (alignment - 1)))
+        errno = EINVAL;
+    else {
+        CDE_SET_HEAPSITE(pCdeAppIf->pCdeServices, _ReturnAddress());  // allocation site for the heap profiler
+        if (CDE_SERVICES_HEAPCTRL(pCdeAppIf->pCdeServices))
+            pRet = pCdeAppIf->pCdeServices->pMemAlignedRealloc(
+                pCdeAppIf,
+                NULL,       //IN void *ptr,   /* input pointer for realloc */
+                size,       //IN size_t size, /*  input size for realloc*/
+                alignment,  //IN size_t alignment,
+                &pCdeAppIf->pCdeServices->HeapStart
+            );
+        else {
+            //
+            // CDE_SERVICES without pMemAlignedRealloc(): the block is released by free(),
+            // so it can't be aligned manually. Accept a native block, that is aligned already.
+            //
+            pRet = pCdeAppIf->pCdeServices->pMemRealloc(pCdeAppIf, NULL, size, &pCdeAppIf->pCdeServices->HeapStart);
+            if (NULL != pRet && 0 != ((size_t)pRet & (alignment - 1))) {
+                pCdeAppIf->pCdeServices->pMemRealloc(pCdeAppIf, pRet, 0, &pCdeAppIf->pCdeServices->HeapStart);
+                pRet = NULL;
+                errno = EINVAL;
+            }
+        }
+    }
+
+    return pRet;
+}
@@ -23,6 +23,8 @@ Author:
 #include <CdeServices.h>
 #include <string.h>
 
+extern void* __cdeMemChr(const void* s, int c, size_t n);
+
 /**
 Synopsis
     #include <string.h>
@@ -37,15 +39,6 @@ Returns
     character does not occur in the object.
 **/
 void* memchr(const void* str, int c, size_t n) {
-    unsigned char u = (unsigned char)c;
-    unsigned char* pRet = (unsigned char*)str;
-
-    while (n) {
-        if (*pRet == u)
-            break;
-        n--;
-        pRet++;
-    }
 
-    return n == 0 ? NULL : pRet;
+    return __cdeMemChr(str, c, n);
 }
\ No newline at end of file
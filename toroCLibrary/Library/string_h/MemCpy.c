@@ -21,6 +21,8 @@ Author:
 
 --*/
 #include <stddef.h>
+
+extern void* __cdeMemCpyFwd(void* pDst, const void* pSrc, size_t n);
 /**
 Synopsis
     #include <string.h>
@@ -33,10 +35,6 @@ Returns
     https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/memcpy-wmemcpy?view=msvc-160#return-value
 **/
 void* memcpy(void* s1, const void* s2, size_t n) {
-    size_t i;
 
-    for (i = 0; i < n; i++) {
-        ((unsigned char*)s1)[i] = ((unsigned char*)s2)[i];
-    }
-    return s1;
+    return __cdeMemCpyFwd(s1, s2, n);
 }
\ No newline at end of file
@@ -0,0 +1,42 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    MemMem.c
+
+Abstract:
+
+    Implementation of the GNU/POSIX C function.
+    Locates a byte sequence in a buffer.
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#include <stddef.h>
+
+extern void* __cdeMemMem(const void* pHay, size_t n, const void* pNeedle, size_t m, int fWide);
+
+/**
+Synopsis
+    #include <string.h>
+    void* memmem(const void* haystack, size_t haystacklen, const void* needle, size_t needlelen);
+Description
+    https://man7.org/linux/man-pages/man3/memmem.3.html
+    The memmem function finds the start of the first occurrence of the substring needle
+    of length needlelen in the memory area haystack of length haystacklen.
+Returns
+    The memmem function returns a pointer to the beginning of the substring, or NULL if the
+    substring is not found. An empty needle is found at the beginning of the haystack.
+**/
+void* memmem(const void* haystack, size_t haystacklen, const void* needle, size_t needlelen) {
+
+    return __cdeMemMem(haystack, haystacklen, needle, needlelen, 0);
+}
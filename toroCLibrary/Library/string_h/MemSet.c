@@ -22,6 +22,8 @@ Author:
 --*/
 #include <stddef.h>
 
+extern void* __cdeMemFill(void* pDst, unsigned long long qwFill, size_t n);
+
 /**
 
 Synopsis
@@ -42,10 +44,6 @@ Returns
 
 **/
 void* memset(void* s, int c, size_t n) {
-    unsigned char* p;
-    size_t i;
 
-    for (i = 0, p = (unsigned char*)s; i < n; i++)
-        p[i] = (unsigned char)c;
-    return s;
+    return __cdeMemFill(s, (unsigned char)c * 0x0101010101010101ULL, n);
 }
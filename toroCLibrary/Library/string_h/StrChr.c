@@ -23,7 +23,7 @@ Author:
 #include <CdeServices.h>
 #include <string.h>
 
-char* strpbrk(const char* pszStr, const char* pszSet);
+extern void* __cdeStrChr(const void* pszStr, int c, int fWide);
 
 /** strchr
 
@@ -51,16 +51,5 @@ Returns
 **/
 char* strchr(const char* str, int c) {
 
-    char buffer[2] = { '\0','\0' };
-    char* pRet;
-
-    buffer[0] = (char)c;
-    if ('\0' != c) {
-        pRet = strpbrk(str, &buffer[0]);
-    }
-    else {
-        pRet = &((char*)/*cast due "warning C4090: '=' : different 'const' qualifiers"*/str)[strlen(str)];
-    }
-
-    return pRet;
+    return __cdeStrChr(str, (char)c, 0);
 }
\ No newline at end of file
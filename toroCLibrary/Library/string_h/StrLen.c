@@ -21,6 +21,8 @@ Author:
 
 --*/
 #include <stddef.h>
+
+extern size_t __cdeStrLen(const char* pszStr);
 /**
 Synopsis
     #include <string.h>
@@ -33,9 +35,6 @@ Returns
     https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/strlen-wcslen-mbslen-mbslen-l-mbstrlen-mbstrlen-l?view=msvc-160#return-value
 **/
 size_t strlen(const char* pszBuffer) {
-    int i = 0;
 
-    while (pszBuffer[i] != '\0')
-        i++;
-    return (size_t)i;
+    return __cdeStrLen(pszBuffer);
 }
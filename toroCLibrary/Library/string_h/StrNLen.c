@@ -22,6 +22,8 @@ Author:
 --*/
 #include <string.h>
 
+extern void* __cdeMemChr(const void* s, int c, size_t n);
+
 /**
 Synopsis
     #include <string.h>
@@ -34,13 +36,7 @@ Returns
     https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/strnlen-strnlen-s?view=msvc-160#return-value
 **/
 size_t strnlen(const char* pszBuffer, size_t n) {
-    size_t i = 0;
-
-    while (pszBuffer[i] != '\0')
-        if (i == n)
-            break;
-        else
-            i++;
+    const char* p = __cdeMemChr(pszBuffer, '\0', n);
 
-    return i;
+    return NULL == p ? n : (size_t)(p - pszBuffer);
 }
@@ -24,6 +24,8 @@ Author:
 #include <string.h>
 #include <stdio.h>
 
+extern void* __cdeStrRChr(const void* pszStr, int c, int fWide);
+
 /** strchr
 Synopsis
     #include <string.h>
@@ -47,17 +49,6 @@ Returns
 
 **/
 char* strrchr(const char* str, int c) {
-    CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
-    char buffer[2] = { '\0','\0' };
-    char* pRet;
-
-    buffer[0] = (char)c;
-    if ('\0' != c) {
-        pRet = pCdeAppIf->pCdeServices->pWcsStrPbrkSpn(TDN, (void*)str, (void*)&buffer[0]);
-    }
-    else {
-        pRet = &((char*)/*cast due "warning C4090: '=' : different 'const' qualifiers"*/str)[strlen(str)];
-    }
-
-    return pRet;
+
+    return __cdeStrRChr(str, (char)c, 0);
 }
\ No newline at end of file
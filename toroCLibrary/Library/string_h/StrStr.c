@@ -22,6 +22,9 @@ Author:
 --*/
 #include <stddef.h>
 
+extern size_t __cdeStrLen(const char* pszStr);
+extern void* __cdeMemMem(const void* pHay, size_t n, const void* pNeedle, size_t m, int fWide);
+
 /**
 Synopsis
     #include <string.h>
@@ -34,33 +37,9 @@ Returns
     https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/strstr-wcsstr-mbsstr-mbsstr-l?view=msvc-160#return-value
 **/
 char* strstr(const char* pszStr, const char* pszSubStr) {
-    const char* pRet = NULL;
-    char* pPos = (char*)&pszStr[-1];
-    int i;
-
-    do {
-
-        if ('\0' == pszSubStr[0]) {
-            pRet = pszStr;
-            break;
-        }
-
-        while (*++pPos) {
-
-
-            pszStr = pPos;
-            i = 0;
-
-            while (pszStr[i] && pszSubStr[i] && (pszStr[i] == pszSubStr[i]))
-                i++;
-
-            if ('\0' == pszSubStr[i]) {
-                pRet = pPos;
-                break;
-            }
 
-        }
-    } while (0);
+    if ('\0' == pszSubStr[0])
+        return (char*)pszStr;
 
-    return (char*)pRet;
+    return __cdeMemMem(pszStr, __cdeStrLen(pszStr), pszSubStr, __cdeStrLen(pszSubStr), 0);
 }
\ No newline at end of file
@@ -22,6 +22,8 @@ Author:
 --*/
 #include <CdeServices.h>
 
+extern void* __cdeWMemChr(const unsigned short* s, unsigned short c, size_t n);
+
 /** wmemchr
 Synopsis
     #include <wchar.h>
@@ -46,12 +48,6 @@ Returns
 
 **/
 wchar_t* wmemchr(const wchar_t* s, wchar_t c, size_t n) {
-    while (n) {
-        if (*s == c)
-            break;
-        n--;
-        s++;
-    }
-
-    return n == 0 ? NULL : (wchar_t*)s;
+
+    return (wchar_t*)__cdeWMemChr((const unsigned short*)s, (unsigned short)c, n);
 }
\ No newline at end of file
@@ -22,6 +22,8 @@ Author:
 --*/
 #include <stddef.h>
 
+extern void* __cdeMemCpyFwd(void* pDst, const void* pSrc, size_t n);
+
 /**
 Synopsis
     #include <wchar.h>
@@ -34,10 +36,6 @@ Returns
     https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/memcpy-wmemcpy?view=msvc-160#return-value
 **/
 wchar_t* wmemcpy(wchar_t* s1, const wchar_t* s2, size_t n) {
-    size_t i;
 
-    for (i = 0; i < n; i++) {
-        s1[i] = s2[i];
-    }
-    return s1;
+    return __cdeMemCpyFwd(s1, s2, n * sizeof(wchar_t));
 }
\ No newline at end of file
@@ -22,6 +22,8 @@ Author:
 --*/
 #include <stddef.h>
 
+extern void* __cdeMemFill(void* pDst, unsigned long long qwFill, size_t n);
+
 /**
 
 Synopsis
@@ -42,9 +44,6 @@ Returns
 
 **/
 wchar_t* wmemset(wchar_t* s, wchar_t c, size_t n) {
-    size_t i;
 
-    for (i = 0; i < n; i++)
-        s[i] = c;
-    return s;
+    return __cdeMemFill(s, (unsigned short)c * 0x0001000100010001ULL, n * sizeof(wchar_t));
 }
\ No newline at end of file
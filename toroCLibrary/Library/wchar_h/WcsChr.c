@@ -24,7 +24,7 @@ Author:
 #include <stddef.h>
 #include <wchar.h>
 
-extern wchar_t* wcspbrk(const wchar_t* pszStr, const wchar_t* pszSet);
+extern void* __cdeStrChr(const void* pszStr, int c, int fWide);
 
 /**
 Synopsis
@@ -39,16 +39,5 @@ Returns
 **/
 wchar_t* wcschr(const wchar_t* wcs, wchar_t c) {
 
-    wchar_t buffer[2] = { '\0','\0' };
-    wchar_t* pRet;
-
-    buffer[0] = (wchar_t)c;
-    if ('\0' != c) {
-        pRet = wcspbrk(wcs, &buffer[0]);
-    }
-    else {
-        pRet = &((wchar_t*)/*cast due "warning C4090: '=' : different 'const' qualifiers"*/wcs)[wcslen(wcs)];
-    }
-
-    return pRet;
+    return __cdeStrChr(wcs, c, 1);
 }
\ No newline at end of file
@@ -24,6 +24,8 @@ Author:
 #include <stddef.h>
 #include <stdio.h>
 
+extern size_t __cdeWcsLen(const unsigned short* pwcsStr);
+
 /**
 Synopsis
     #include <wchar.h>
@@ -36,9 +38,6 @@ Returns
     https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/strlen-wcslen-mbslen-mbslen-l-mbstrlen-mbstrlen-l?view=msvc-160#return-value
 **/
 size_t wcslen(const short* pszBuffer) {
-    int i = 0;
 
-    while (pszBuffer[i] != '\0')
-        i++;
-    return (size_t)i;
+    return __cdeWcsLen((const unsigned short*)pszBuffer);
 }
\ No newline at end of file
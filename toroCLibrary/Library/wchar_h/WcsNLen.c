@@ -22,6 +22,8 @@ Author:
 --*/
 #include <string.h>
 
+extern void* __cdeWMemChr(const unsigned short* s, unsigned short c, size_t n);
+
 /**
 Synopsis
     #include <wchar.h>
@@ -34,13 +36,7 @@ Returns
     https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/strnlen-strnlen-s?view=msvc-160#return-value
 **/
 size_t wcsnlen(const wchar_t* pwcsBuffer, size_t n) {
-    size_t i = 0;
-
-    while (pwcsBuffer[i] != '\0')
-        if (i == n)
-            break;
-        else
-            i++;
+    const wchar_t* p = __cdeWMemChr((const unsigned short*)pwcsBuffer, '\0', n);
 
-    return i;
+    return NULL == p ? n : (size_t)(p - pwcsBuffer);
 }
@@ -24,6 +24,8 @@ Author:
 #include <stddef.h>
 #include <CdeServices.h>
 
+extern void* __cdeStrRChr(const void* pszStr, int c, int fWide);
+
 /** wcsrchr()
 Synopsis
     #include <wchar.h>
@@ -47,17 +49,6 @@ Returns
 
 **/
 wchar_t* wcsrchr(const wchar_t* wcs, wchar_t c) {
-    CDE_APP_IF* pCdeAppIf = __cdeGetAppIf();
-    wchar_t buffer[2] = { '\0','\0' };
-    wchar_t* pRet;
-
-    buffer[0] = (wchar_t)c;
-    if ('\0' != c) {
-        pRet = pCdeAppIf->pCdeServices->pWcsStrPbrkSpn(TDN + WID, (void*)wcs, (void*)&buffer[0]);
-    }
-    else {
-        pRet = &((wchar_t*)/*cast due "warning C4090: '=' : different 'const' qualifiers"*/wcs)[wcslen(wcs)];
-    }
-
-    return pRet;
+
+    return __cdeStrRChr(wcs, c, 1);
 }
\ No newline at end of file
@@ -22,6 +22,9 @@ Author:
 --*/
 #include <stddef.h>
 
+extern size_t __cdeWcsLen(const unsigned short* pwcsStr);
+extern void* __cdeMemMem(const void* pHay, size_t n, const void* pNeedle, size_t m, int fWide);
+
 /**
 Synopsis
     #include <wchar.h>
@@ -34,31 +37,9 @@ Returns
     https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/strstr-wcsstr-mbsstr-mbsstr-l?view=msvc-160#return-value
 **/
 wchar_t* wcsstr(const wchar_t* pszStr, const wchar_t* pszSubStr) {
-    const wchar_t* pRet = NULL;
-    wchar_t* pPos = (wchar_t*)&pszStr[-1];
-    int i;
-
-    do {
-
-        if ('\0' == pszSubStr[0]) {
-            pRet = pszStr;
-            break;
-        }
-
-        while (*++pPos) {
-
-            pszStr = pPos;
-            i = 0;
-
-            while (pszStr[i] && pszSubStr[i] && (pszStr[i] == pszSubStr[i]))
-                i++;
 
-            if ('\0' == pszSubStr[i]) {
-                pRet = pPos;
-                break;
-            }
-        }
-    } while (0);
+    if ('\0' == pszSubStr[0])
+        return (wchar_t*)pszStr;
 
-    return (wchar_t*)pRet;
+    return __cdeMemMem(pszStr, __cdeWcsLen((const unsigned short*)pszStr), pszSubStr, __cdeWcsLen((const unsigned short*)pszSubStr), 1);
 }
@@ -54,6 +54,7 @@ extern EFI_STATUS EFIAPI OemHookStatusCodeInitialize(void);
 extern void free(void* ptr);
 extern int _cdeStr2Argcv(char** argv, char* szCmdline);
 extern char __cdeGetCurrentPrivilegeLevel(void);
+extern MEMRELEASE _cdeMemRelease;
 
 extern EFI_GUID gEfiLoadedImageProtocolGuid;
 extern EFI_GUID _gCdeDxeProtocolGuid;                   // The GUID for the protocol
@@ -186,6 +187,16 @@ EFI_STATUS EFIAPI _cdeCRT0UefiDxeEDK(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TA
             break;//do{}while(0);
         }
 
+        //
+        // reject CdeServices with an incompatible layout
+        //
+        if (CDE_SERVICES_VER_MAJOR != CdeAppIfDxe.pCdeServices->wVerMajor)
+        {
+            __cdeFatalCdeServicesNotAvailDXE(SystemTable);
+            Status = EFI_INCOMPATIBLE_VERSION;
+            break;//do{}while(0);
+        }
+
         CdeAppIfDxe.DriverParm.BsDriverParm.ImageHandle = ImageHandle;
         CdeAppIfDxe.DriverParm.BsDriverParm.pSystemTable = SystemTable;
 
@@ -278,16 +289,7 @@ EFI_STATUS EFIAPI _MainEntryPointDxe(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TA
         //
         if (CDE_FREE_MEMORY_ALLOCATION_ON_EXIT)
         {
-            HEAPDESC* pHeap = &CdeAppIfDxe.pCdeServices->HeapStart;
-            do
-            {
-                if (pHeap->qwMagic == ALLOCMEM)
-                {
-                    free(&pHeap[1]);
-                    pHeap = &CdeAppIfDxe.pCdeServices->HeapStart;
-                }
-                pHeap = pHeap->pSucc;
-            } while (pHeap);
+            _cdeMemRelease(&CdeAppIfDxe, &CdeAppIfDxe.pCdeServices->HeapStart);
 
         }//if( CDE_FREE_MEMORY_ALLOCATION_ON_EXIT ) 
 
@@ -43,7 +43,9 @@ extern GUID gEfiCallerIdGuid;
 extern char* gEfiCallerBaseName;
 extern int _cdeStr2Argcv(char** argv, char* szCmdline);
 extern char __cdeGetCurrentPrivilegeLevel(void);
+extern MEMRELEASE _cdeMemRelease;
 extern void* __cdeGetPeiServices(void);
+extern int _osifUefiPeiIsPreMemory(IN EFI_PEI_SERVICES** PeiServices);
 
 //
 // 
@@ -297,8 +299,24 @@ _MainEntryPointPei(
             break;//do{}while(0);
         }
 
+        //
+        // reject CdeServices with an incompatible layout
+        //
+        if (CDE_SERVICES_VER_MAJOR != pCdeServices->wVerMajor)
+        {
+            __cdeFatalCdeServicesNotAvailPEI(PeiServices);
+            Status = EFI_INCOMPATIBLE_VERSION;
+            break;//do{}while(0);
+        }
+
         pCdeAppIf = __cdeGetAppIf();
 
+        //
+        // allocate from the compact heap in Pre-Memory-PEI
+        //
+        if (CDE_SERVICES_HEAPCTRL(pCdeServices))
+            pCdeServices->HeapCtrl.fTinyHeap = (unsigned char)_osifUefiPeiIsPreMemory((EFI_PEI_SERVICES**)PeiServices);
+
         //
         // get the LoadOptions / command line from the LoadOptions driver
         //
@@ -351,16 +369,7 @@ _MainEntryPointPei(
         //
         if (CDE_FREE_MEMORY_ALLOCATION_ON_EXIT)
         {
-            HEAPDESC* pHeap = &pCdeAppIf->pCdeServices->HeapStart;
-            do
-            {
-                if (pHeap->qwMagic == ALLOCMEM)
-                {
-                    free(&pHeap[1]);
-                    pHeap = &pCdeAppIf->pCdeServices->HeapStart;
-                }
-                pHeap = pHeap->pSucc;
-            } while (pHeap);
+            _cdeMemRelease(pCdeAppIf, &pCdeAppIf->pCdeServices->HeapStart);
 
         }//if( CDE_FREE_MEMORY_ALLOCATION_ON_EXIT ) 
 
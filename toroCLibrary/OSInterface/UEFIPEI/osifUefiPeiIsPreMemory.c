@@ -0,0 +1,47 @@
+/*++
+
+    toro C Library
+    https://github.com/KilianKegel/toro-C-Library#toro-c-library-formerly-known-as-torito-c-library
+
+    Copyright (c) 2017-2022, Kilian Kegel. All rights reserved.
+    SPDX-License-Identifier: GNU General Public License v3.0
+
+Module Name:
+
+    osifUefiPeiIsPreMemory.c
+
+Abstract:
+
+    OS interface (osif) Pre-Memory-PEI detection
+
+Author:
+
+    Kilian Kegel
+
+--*/
+#define OS_EFI
+#include <CdeServices.h>
+#include <Ppi\MemoryDiscovered.h>   //MdePkg\Include\Ppi\MemoryDiscovered.h
+
+/** _osifUefiPeiIsPreMemory() - check for Pre-Memory-PEI
+
+Synopsis
+    #include <CdeServices.h>
+    int _osifUefiPeiIsPreMemory(IN EFI_PEI_SERVICES** PeiServices);
+Description
+    Check, if the permanent memory is not yet installed, the PEI core is running
+    from temporary RAM (cache as RAM).
+    Permanent memory is installed, when the EFI_PEI_PERMANENT_MEMORY_INSTALLED_PPI is present.
+Parameters
+    EFI_PEI_SERVICES** PeiServices  - PEI services
+Returns
+    TRUE in Pre-Memory-PEI
+    FALSE in Post-Memory-PEI
+**/
+int _osifUefiPeiIsPreMemory(IN EFI_PEI_SERVICES** PeiServices) {
+
+    static EFI_GUID gPermanentMemoryInstalledPpiGuid = EFI_PEI_PERMANENT_MEMORY_INSTALLED_PPI_GUID;
+    void* pPpi;
+
+    return EFI_SUCCESS != (*PeiServices)->LocatePpi(PeiServices, &gPermanentMemoryInstalledPpiGuid, 0, NULL, &pPpi);
+}
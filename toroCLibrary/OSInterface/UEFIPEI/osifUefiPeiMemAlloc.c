@@ -22,6 +22,8 @@ Author:
 #define OS_EFI
 #include <CdeServices.h>
 
+extern int _osifUefiPeiIsPreMemory(IN EFI_PEI_SERVICES** PeiServices);
+
 /** _osifMemAlloc() - allocate memory  pages
 
 Synopsis
@@ -29,6 +31,8 @@ Synopsis
     HEAPDESC* _osifUefiPeiMemAlloc(IN CDE_APP_IF* pCdeAppIf, IN unsigned int Pages);
 Description
     Get memory pages.
+    Pages allocated in Pre-Memory-PEI, or if the PEI services don't provide FreePages(),
+    are marked inalterable.
 Parameters
     CDE_APP_IF* pCdeAppIf   - application interface
     unsigned int Pages      - number of pages
@@ -39,16 +43,18 @@ HEAPDESC* _osifUefiPeiMemAlloc(IN CDE_APP_IF* pCdeAppIf, IN unsigned int Pages)
 
     EFI_PHYSICAL_ADDRESS Memory = (EFI_PHYSICAL_ADDRESS)-1; //NOTE: iapx86 specific -> little endian dependant
     HEAPDESC** ppMemory = (HEAPDESC**)&Memory; 				//NOTE: iapx86 specific -> little endian dependant
+    EFI_PEI_SERVICES** PeiServices = pCdeAppIf->DriverParm.PeimParm.PeiServices;
     EFI_STATUS Status;
 
-    Status = (*pCdeAppIf->DriverParm.PeimParm.PeiServices)->AllocatePages(
-        pCdeAppIf->DriverParm.PeimParm.PeiServices,
+    Status = (*PeiServices)->AllocatePages(
+        PeiServices,
         EfiLoaderData,
         Pages,
         &Memory);
 
     if (Status == EFI_SUCCESS) {
-        (*ppMemory)->fInalterable = TRUE/*PEIIF == pCdeAppIf->DriverParm.CommParm.OSIf*/;
+        (*ppMemory)->fInalterable = (*PeiServices)->Hdr.Revision < ((1 << 16) | 70)/*FreePages() since PI 1.7*/
+            || _osifUefiPeiIsPreMemory(PeiServices);
     }
     else
         Memory = 0;
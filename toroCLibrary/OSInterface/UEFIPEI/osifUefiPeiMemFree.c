@@ -22,13 +22,16 @@ Author:
 #define OS_EFI
 #include <CdeServices.h>
 
+extern int _osifUefiPeiIsPreMemory(IN EFI_PEI_SERVICES** PeiServices);
+
 /** _osifMemFree() - free memory  pages
 
 Synopsis
     #include <CdeServices.h>
     void _osifUefiPeiMemFree(IN CDE_APP_IF* pCdeAppIf, IN EFI_PHYSICAL_ADDRESS Memory, IN unsigned int Pages);
 Description
-    PEI can not release pages
+    Release memory pages in Post-Memory-PEI, if the PEI services provide FreePages().
+    Otherwise PEI can not release pages.
 Parameters
     CDE_APP_IF* pCdeAppIf       - application interface
     EFI_PHYSICAL_ADDRESS Memory - 64Bit physical address
@@ -37,5 +40,12 @@ Returns
     void
 **/
 void _osifUefiPeiMemFree(IN CDE_APP_IF* pCdeAppIf, IN EFI_PHYSICAL_ADDRESS Memory, IN unsigned int Pages) {
-    return;//PEI can not release pages
+
+    EFI_PEI_SERVICES** PeiServices = pCdeAppIf->DriverParm.PeimParm.PeiServices;
+
+    if ((*PeiServices)->Hdr.Revision < ((1 << 16) | 70)/*FreePages() since PI 1.7*/
+        || _osifUefiPeiIsPreMemory(PeiServices))
+        return;//PEI can not release pages
+
+    (*PeiServices)->FreePages(PeiServices, Memory, Pages);
 }
\ No newline at end of file
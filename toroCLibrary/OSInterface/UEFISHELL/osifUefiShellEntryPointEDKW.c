@@ -77,6 +77,13 @@ extern WCSSTRTOK        _cdeWcsStrTok;
 extern WCSSTRPBRKSPN    _cdeWcsStrPbrkSpn;
 extern void EFIAPI      DebugPrint(IN UINTN ErrorLevel, IN const char* Format, ...);
 extern MEMREALLOC       _cdeMemRealloc;
+extern MEMALIGNEDREALLOC _cdeMemAlignedRealloc;
+extern MEMSIZEDFREE     _cdeMemSizedFree;
+extern ARENACREATE      _cdeArenaCreate;
+extern ARENAALLOC       _cdeArenaAlloc;
+extern ARENARESET       _cdeArenaReset;
+extern ARENADESTROY     _cdeArenaDestroy;
+extern MEMRELEASE       _cdeMemRelease;
 extern MEMSTRXCPY       _cdeMemStrxCpy;
 extern MEMSTRXCMP       _cdeMemStrxCmp;
 extern OSIFGETTIME		_osifIbmAtGetTime;
@@ -209,8 +216,8 @@ static CDE_SERVICES gCdeServicesShell = {/*CDE_PROTOCOL*/
     .TimeAtSystemStart = 0,         /* assuming 01.01.1970  */
     .TSClocksPerSec = 2000000000,   /* assuming 2GHz        */
 
-    .wVerMajor = 0,
-    .wVerMinor = 0,
+    .wVerMajor = CDE_SERVICES_VER_MAJOR,
+    .wVerMinor = CDE_SERVICES_VER_MINOR,
     //////todo filedate??? __TIMESTAMP__
     ////    UINT16 wPtclSize;
     .fx64Opcode = 8 == sizeof(void*),
@@ -229,6 +236,12 @@ static CDE_SERVICES gCdeServicesShell = {/*CDE_PROTOCOL*/
     .pVwxPrintf = _cdeVwxPrintf,
     .pVwxScanf = _cdeVwxScanf,
     .pMemRealloc = _cdeMemRealloc,
+    .pMemAlignedRealloc = _cdeMemAlignedRealloc,
+    .pMemSizedFree = _cdeMemSizedFree,
+    .pArenaCreate = _cdeArenaCreate,
+    .pArenaAlloc = _cdeArenaAlloc,
+    .pArenaReset = _cdeArenaReset,
+    .pArenaDestroy = _cdeArenaDestroy,
     .pMemStrxCpy = _cdeMemStrxCpy,
     .pMemStrxCmp = _cdeMemStrxCmp,
     ////    FNDECL_IOREADX(*pioreadx);
@@ -570,14 +583,7 @@ _MainEntryPointShellW(
             // free memory allocated during runtime
             //
             if (CDE_FREE_MEMORY_ALLOCATION_ON_EXIT) {
-                HEAPDESC* pHeap = &CdeAppIfShellW.pCdeServices->HeapStart;
-                do {
-                    if (pHeap->qwMagic == ALLOCMEM) {
-                        free(&pHeap[1]);
-                        pHeap = &CdeAppIfShellW.pCdeServices->HeapStart;
-                    }
-                    pHeap = pHeap->pSucc;
-                } while (pHeap);
+                _cdeMemRelease(&CdeAppIfShellW, &CdeAppIfShellW.pCdeServices->HeapStart);
             }//if(1)
             
             if (    (0 == (O_CDEREDIR & CDE_STDOUT->openmode))
@@ -55,6 +55,9 @@ extern EFI_STATUS EFIAPI OemHookStatusCodeInitialize(void);
 extern void free(void* ptr);
 extern int _cdeStr2Argcv(char** argv, char* szCmdline);
 extern char __cdeGetCurrentPrivilegeLevel(void);
+extern MEMRELEASE _cdeMemRelease;
+extern HEAPPOOLCREATE _cdeHeapPoolCreate;
+extern unsigned long _gCdeCfgSmmPoolPages;
 
 extern EFI_GUID gEfiLoadedImageProtocolGuid;
 extern EFI_GUID _gCdeSmmProtocolGuid;                   // The GUID for the protocol
@@ -218,6 +221,16 @@ EFI_STATUS EFIAPI _cdeCRT0UefiSmmEDK(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TA
             __cdeFatalCdeServicesNotAvailSmm(SystemTable);
             break;//do{}while(0);
         }
+
+        //
+        // reject CdeServices with an incompatible layout
+        //
+        if (CDE_SERVICES_VER_MAJOR != CdeAppIfSmm.pCdeServices->wVerMajor)
+        {
+            __cdeFatalCdeServicesNotAvailSmm(SystemTable);
+            Status = EFI_INCOMPATIBLE_VERSION;
+            break;//do{}while(0);
+        }
         //
         // set handle, SytemTable and SMM Systemtable zo CdeAppIf
         //
@@ -261,6 +274,12 @@ EFI_STATUS EFIAPI _MainEntryPointSmm(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TA
 
     do {
 
+        //
+        // reserve the fixed SMRAM pool for bounded time memory allocation
+        //
+        if (0 != _gCdeCfgSmmPoolPages)
+            _cdeHeapPoolCreate(&CdeAppIfSmm, _gCdeCfgSmmPoolPages, &CdeAppIfSmm.pCdeServices->HeapStart);
+
         if (1)
         {
             char fLoadOptionsAvail = FALSE;
@@ -311,16 +330,7 @@ EFI_STATUS EFIAPI _MainEntryPointSmm(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TA
         if (CDE_FREE_MEMORY_ALLOCATION_ON_EXIT)
         {
 
-            HEAPDESC* pHeap = &CdeAppIfSmm.pCdeServices->HeapStart;
-            do
-            {
-                if (pHeap->qwMagic == ALLOCMEM)
-                {
-                    free(&pHeap[1]);
-                    pHeap = &CdeAppIfSmm.pCdeServices->HeapStart;
-                }
-                pHeap = pHeap->pSucc;
-            } while (pHeap);
+            _cdeMemRelease(&CdeAppIfSmm, &CdeAppIfSmm.pCdeServices->HeapStart);
 
         }//if( CDE_FREE_MEMORY_ALLOCATION_ON_EXIT ) 
 
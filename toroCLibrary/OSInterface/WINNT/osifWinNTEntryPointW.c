@@ -75,6 +75,13 @@ extern VWXSCANF _cdeVwxScanf;
 extern WCSSTRTOK _cdeWcsStrTok;
 extern WCSSTRPBRKSPN _cdeWcsStrPbrkSpn;
 extern MEMREALLOC _cdeMemRealloc;
+extern MEMALIGNEDREALLOC _cdeMemAlignedRealloc;
+extern MEMSIZEDFREE _cdeMemSizedFree;
+extern ARENACREATE _cdeArenaCreate;
+extern ARENAALLOC _cdeArenaAlloc;
+extern ARENARESET _cdeArenaReset;
+extern ARENADESTROY _cdeArenaDestroy;
+extern MEMRELEASE _cdeMemRelease;
 extern MEMSTRXCPY _cdeMemStrxCpy;
 extern MEMSTRXCMP _cdeMemStrxCmp;
 extern OSIFGETTIME		  _osifWinNTGetTime;
@@ -161,12 +168,13 @@ static CDE_SERVICES gCdeServicesWinNT = {/*CDE_PROTOCOL*/
     .TimeAtSystemStart = 0,         /* assuming 01.01.1970  */
     .TSClocksPerSec = 2000000000,   /* assuming 2GHz        */
 
-    .wVerMajor = 0,
-    .wVerMinor = 0,
+    .wVerMajor = CDE_SERVICES_VER_MAJOR,
+    .wVerMinor = CDE_SERVICES_VER_MINOR,
     //////todo filedate??? __TIMESTAMP__
     ////    UINT16 wPtclSize;
     .fx64Opcode = 8 == sizeof(void*),
     .HeapStart = {(void*)-1,ENDOFMEM,1,NULL,NULL,0,0,(void*)-1},
+    .HeapCtrl = {.fZeroPages = TRUE},       // VirtualAlloc() provides zeroed pages
     .TSClocksAtCdeTrace = 0,
     .TimeAtSystemStart = 0,
     .ReportStatusCode = 0,
@@ -181,6 +189,12 @@ static CDE_SERVICES gCdeServicesWinNT = {/*CDE_PROTOCOL*/
     .pVwxPrintf = _cdeVwxPrintf,
     .pVwxScanf = _cdeVwxScanf,
     .pMemRealloc = _cdeMemRealloc,
+    .pMemAlignedRealloc = _cdeMemAlignedRealloc,
+    .pMemSizedFree = _cdeMemSizedFree,
+    .pArenaCreate = _cdeArenaCreate,
+    .pArenaAlloc = _cdeArenaAlloc,
+    .pArenaReset = _cdeArenaReset,
+    .pArenaDestroy = _cdeArenaDestroy,
     .pMemStrxCpy = _cdeMemStrxCpy,
     .pMemStrxCmp = _cdeMemStrxCmp,
     ////    FNDECL_IOREADX(*pioreadx);
@@ -395,14 +409,7 @@ int _MainEntryPointWinNTW(void)
             // free memory allocated during runtime
             //
             if (CDE_FREE_MEMORY_ALLOCATION_ON_EXIT) {
-                HEAPDESC* pHeap = &pCdeAppIf->pCdeServices->HeapStart;
-                do {
-                    if (pHeap->qwMagic == ALLOCMEM) {
-                        free(&pHeap[1]);
-                        pHeap = &pCdeAppIf->pCdeServices->HeapStart;
-                    }
-                    pHeap = pHeap->pSucc;
-                } while (pHeap);
+                _cdeMemRelease(pCdeAppIf, &pCdeAppIf->pCdeServices->HeapStart);
             }//if(1)
 
         } while (_0);